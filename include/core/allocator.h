@@ -6,6 +6,7 @@
 #endif
 #include <cstddef>
 #include <map>
+#include <set>
 #include <unordered_set>
 
 namespace infini {
@@ -27,7 +28,13 @@ namespace infini {
     // TODO：可能需要设计一个数据结构来存储free block，以便于管理和合并
     // HINT: 可以使用一个 map 来存储 free block，key 为 block 的起始/结尾地址，value 为 block 的大小
     // =================================== 作业 ===================================
-    std::unordered_map<size_t, size_t> recycle_map_;
+    // free blocks ordered by address (head address -> size), used to merge a
+    // freed block with its neighbours
+    std::map<size_t, size_t> freeBlocks_;
+    // the same free blocks ordered by (size, head address), used to find the
+    // best fit
+    std::set<std::pair<size_t, size_t>> freeBlocksBySize_;
+
   public:
     Allocator(Runtime runtime);
 
@@ -51,9 +58,15 @@ namespace infini {
 
     void info();
 
+    size_t getAlignment() const { return alignment; }
+
   private:
     // function: memory alignment, rouned up
     // return: size of the aligned memory block
     size_t getAlignedSize(size_t size);
+
+    void insertFreeBlock(size_t addr, size_t size);
+
+    void eraseFreeBlock(std::map<size_t, size_t>::iterator it);
   };
 }
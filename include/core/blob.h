@@ -11,12 +11,16 @@ class BlobObj
 {
   Runtime runtime;
   void *ptr;
+  // Whether the blob allocated ptr itself and frees it
+  bool owned = false;
 
 public:
   BlobObj(Runtime runtime, void *ptr) : runtime(runtime), ptr(ptr) {}
+  // A blob with memory of its own, outside of any allocator
+  BlobObj(Runtime runtime, size_t size);
   BlobObj(BlobObj &other) = delete;
   BlobObj &operator=(BlobObj const &) = delete;
-  ~BlobObj() {};
+  ~BlobObj();
 
   template <typename T>
   T getPtr() const { return reinterpret_cast<T>(ptr); }
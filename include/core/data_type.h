@@ -1,5 +1,6 @@
 #pragma once
 #include "core/common.h"
+#include "utils/half.h"
 
 namespace infini {
 
@@ -22,7 +23,7 @@ class DataType {
     static const DataType UInt64;
     static const DataType BFloat16;
     // "sizePerElement" show the DType to cpu_type
-    // DataType::Bool -> int8_t   DataType::Float16 -> uint16_t
+    // DataType::Bool -> int8_t   DataType::Float16 -> float16_t
     static constexpr size_t sizePerElement[]{0,
                                              sizeof(float),
                                              sizeof(uint8_t),
@@ -47,8 +48,8 @@ class DataType {
         "Float16",     "Double",  "UInt32", "UInt64", "PlaceHolder",
         "PlaceHolder", "BFloat16"};
 
-    static constexpr int cpuType[]{-1, 0, 2, 3, 4, 5,  6,  7, -1,
-                                   3,  4, 9, 1, 8, -1, -1, 4};
+    static constexpr int cpuType[]{-1, 0, 2, 3, 4,  5,  6,  7, -1,
+                                   3,  10, 9, 1, 8, -1, -1, 11};
 
   private:
     int index;
@@ -59,6 +60,7 @@ class DataType {
     DataType() = default;
     constexpr DataType(int index) : index(index) {}
     bool operator==(const DataType &rhs) const { return index == rhs.index; }
+    bool operator!=(const DataType &rhs) const { return index != rhs.index; }
     bool operator<(const DataType &rhs) const { return index < rhs.index; }
 
     template <typename T> static int get() {
@@ -82,6 +84,8 @@ template <> inline int DataType::get<int32_t>() { return 6; }
 template <> inline int DataType::get<int64_t>() { return 7; }
 template <> inline int DataType::get<uint64_t>() { return 8; }
 template <> inline int DataType::get<double>() { return 9; }
+template <> inline int DataType::get<float16_t>() { return 10; }
+template <> inline int DataType::get<bfloat16_t>() { return 11; }
 
 template <int index> struct DT {};
 template <> struct DT<0> { using t = bool; };
@@ -94,10 +98,46 @@ template <> struct DT<6> { using t = int32_t; };
 template <> struct DT<7> { using t = int64_t; };
 template <> struct DT<8> { using t = char; };
 template <> struct DT<9> { using t = int8_t; };
-template <> struct DT<10> { using t = uint16_t; };
+template <> struct DT<10> { using t = float16_t; };
 template <> struct DT<11> { using t = double; };
 template <> struct DT<12> { using t = uint32_t; };
 template <> struct DT<13> { using t = uint64_t; };
-template <> struct DT<16> { using t = uint16_t; };
+template <> struct DT<16> { using t = bfloat16_t; };
+
+template <typename T> struct TypeTag { using type = T; };
+// A set of DataType indices to dispatch over
+template <int... N> struct DTypes {};
+// Whether 'dtype' is in 'dtypes', so that dispatchDType does not halt
+template <int... N> bool hasDType(DataType dtype, DTypes<N...>) {
+    return ((dtype.getIndex() == N) || ...);
+}
+// Every dtype with a C++ type
+using AllDTypes = DTypes<0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 16>;
+// The dtypes of the arithmetic CPU kernels: Float32, Int8, Int32, Int64,
+// Float16, Double, UInt32 and BFloat16
+using ArithmeticDTypes = DTypes<1, 3, 6, 7, 10, 11, 12, 16>;
+
+/**
+ * @brief Calls f(TypeTag<DT<N>::t>()) for the N of 'dtypes' that is the index
+ * of 'dtype' and returns its result, e.g.
+ *
+ *     dispatchDType(dtype, ArithmeticDTypes(), [&](auto tag) {
+ *         using T = typename decltype(tag)::type;
+ *         ...
+ *     });
+ *
+ * Halts if 'dtype' is not in 'dtypes'.
+ */
+template <int N, int... Rest, typename F>
+decltype(auto) dispatchDType(DataType dtype, DTypes<N, Rest...>, F &&f) {
+    if constexpr (sizeof...(Rest) > 0) {
+        if (dtype.getIndex() != N)
+            return dispatchDType(dtype, DTypes<Rest...>(), std::forward<F>(f));
+    } else {
+        IT_ASSERT(dtype.getIndex() == N,
+                  "Unsupported data type " + dtype.toString());
+    }
+    return f(TypeTag<typename DT<N>::t>());
+}
 
 } // namespace infini
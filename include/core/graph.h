@@ -8,6 +8,8 @@ namespace infini
 
     class GraphObj : public Object
     {
+        friend class GraphRewriter;
+
     protected:
         Runtime runtime;
         TensorVec tensors;
@@ -37,6 +39,14 @@ namespace infini
                 tensors.erase(it);
         }
 
+        /**
+         * @brief Marks a tensor without a source as a constant, such as a
+         * weight or an initializer. It gets memory of its own at once, out of
+         * the memory planned by dataMalloc, so that its data is set before
+         * optimize(), which evaluates the operators that only read constants.
+         */
+        void setConstant(const Tensor &tensor);
+
         const TensorVec &getTensors() const { return tensors; }
         const OpVec &getOperators() const { return ops; }
         Tensor getTensor(int) const;
@@ -53,7 +63,19 @@ namespace infini
 
         void shape_infer();
 
-        void dataMalloc();
+        /**
+         * @brief Plan the memory of all tensors on the allocator according to
+         * their lifetimes and bind them to the allocated memory.
+         *
+         * @param inplace If true, an operator whose kernel supports in-place
+         * execution writes its output to the memory of an input of the same
+         * shape that is not read afterwards, and a transpose that only moves
+         * size-1 dims shares the memory of its input.
+         * @param zeroCopyConcat If true, the sources of concat inputs write
+         * directly to their slices of the concat output when the slices are
+         * contiguous, and the concat kernel does not copy them.
+         */
+        void dataMalloc(bool inplace = true, bool zeroCopyConcat = true);
 
         /**
          * @brief Add an operator and create its outputs. Output tensor arguments
@@ -78,6 +100,18 @@ namespace infini
             return op;
         }
 
+        /**
+         * @brief Add a clone of 'op' whose inputs and outputs are the given
+         * tensors of this graph.
+         */
+        Operator cloneOperator(const Operator &op, const TensorVec &inputs,
+                               const TensorVec &outputs)
+        {
+            auto opClone = op->clone(inputs, outputs);
+            addOperatorAndConnect(opClone);
+            return opClone;
+        }
+
         /**
          * @brief Gets input tensors of this graph.
          */
@@ -0,0 +1,150 @@
+#pragma once
+#include "core/graph.h"
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace infini
+{
+    /**
+     * @brief A pattern rooted at an operator: its type, an optional predicate
+     * on its attributes, and patterns for the producers of some of its
+     * inputs.
+     */
+    struct Pattern
+    {
+        OpType type;
+        std::function<bool(const Operator &)> predicate = nullptr;
+        // (input index, pattern of the operator that produces that input)
+        vector<pair<size_t, Pattern>> inputs = {};
+        // For a producer: its outputs are read by the matched consumer only,
+        // so the rewrite may fold it away.
+        bool singleUse = false;
+    };
+
+    // The matched operators, the root first, then the input patterns depth
+    // first in the order they are listed
+    using Match = OpVec;
+
+    class GraphRewriter;
+
+    /**
+     * @brief A rewrite of the operators that match a pattern. 'rewrite'
+     * returns false if it leaves the graph unchanged.
+     */
+    struct RewriteRule
+    {
+        std::string name;
+        Pattern pattern;
+        std::function<bool(GraphRewriter &, const Match &)> rewrite;
+    };
+
+    /**
+     * @brief Applies rewrite rules to a graph until none of them matches.
+     *
+     * Every operator is visited once in topological order. After a rewrite,
+     * only the operators it touched and their neighbours are visited again,
+     * and the operators left without readers are removed. Removed operators
+     * and tensors are dropped from the graph in one pass at the end, so a
+     * rewrite costs time in the size of its neighbourhood rather than of the
+     * graph.
+     *
+     * Rules edit the graph through the helpers below, which keep the inputs,
+     * outputs, targets, predecessors and successors consistent.
+     */
+    class GraphRewriter
+    {
+    public:
+        explicit GraphRewriter(GraphObj *graph);
+
+        /**
+         * @brief Runs the rules to a fixed point and returns how many
+         * rewrites were applied.
+         */
+        size_t run(const vector<RewriteRule> &rules);
+
+        GraphObj *getGraph() const { return graph; }
+
+        // The tensors read by the user of the graph, which must be kept.
+        bool isGraphOutput(const Tensor &tensor) const
+        {
+            return graphOutputs.count(tensor.get());
+        }
+        bool isRemoved(const Operator &op) const
+        {
+            return removed.count(op.get());
+        }
+
+        /**
+         * @brief Adds an operator whose outputs are created, see
+         * GraphObj::addOp.
+         */
+        template <typename T, typename... Args>
+        Ref<T> addOp(Args &&...args)
+        {
+            auto op = graph->addOp<T>(std::forward<Args>(args)...);
+            touch(op);
+            return op;
+        }
+
+        /**
+         * @brief Adds an operator with its outputs specified, see
+         * GraphObj::addOpWithOutputs. It may write the outputs of an
+         * operator that is removed afterwards.
+         */
+        template <typename T, typename... Args>
+        Ref<T> addOpWithOutputs(Args &&...args)
+        {
+            auto op = graph->addOpWithOutputs<T>(std::forward<Args>(args)...);
+            touch(op);
+            return op;
+        }
+
+        Operator cloneOperator(const Operator &op, const TensorVec &inputs,
+                               const TensorVec &outputs)
+        {
+            auto clone = graph->cloneOperator(op, inputs, outputs);
+            touch(clone);
+            return clone;
+        }
+
+        // Makes input 'index' of 'op' read 'tensor'
+        void replaceInput(const Operator &op, size_t index, const Tensor &tensor);
+        // Makes all the readers of 'from' read 'to' instead. 'from' must not
+        // be a graph output.
+        void replaceAllUses(const Tensor &from, const Tensor &to);
+        // Removes an operator whose outputs are not read any more, or are
+        // written by another operator now
+        void removeOperator(const Operator &op);
+        // Marks an operator whose attributes changed, so that the rules
+        // visit it and its neighbours again
+        void touch(const Operator &op);
+
+    private:
+        bool match(const Pattern &pattern, const Operator &op, Match &ans) const;
+        void enqueue(const Operator &op);
+        // Re-enqueues the touched operators and their neighbours, and
+        // removes those of them that became dead
+        void flushTouched();
+        // Rebuilds the predecessors of 'op' from its inputs
+        void relinkPredecessors(const Operator &op);
+        // Drops the removed operators, their outputs, and the constants and
+        // read inputs left without readers from the graph
+        void compact();
+
+        GraphObj *graph;
+        std::unordered_set<TensorObj *> graphOutputs;
+        // The inputs of the graph that had readers, which are dropped if the
+        // rewrites leave them without any. Inputs that were never read stay.
+        std::unordered_set<TensorObj *> readInputs;
+        // Removed operators are kept alive until the end, so that their
+        // addresses are not reused by new operators
+        OpVec removedOps;
+        std::unordered_set<OperatorObj *> removed;
+        std::deque<Operator> worklist;
+        std::unordered_set<OperatorObj *> queued;
+        OpVec touched;
+    };
+
+} // namespace infini
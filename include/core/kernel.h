@@ -21,6 +21,14 @@ namespace infini
          */
         virtual void compute(const Operator &op,
                              const RuntimeObj *context) const = 0;
+
+        /**
+         * @brief Whether the kernel still computes the right result when its
+         * output shares memory with an input of the same shape, i.e. every
+         * output element only depends on the input elements at the same
+         * position.
+         */
+        virtual bool supportInplace() const { return false; }
     };
 
     class KernelRegistry
@@ -51,6 +59,10 @@ namespace infini
             kernels.emplace(key, KernelRecord{kernel, name, ++nKernels});
             return true;
         }
+        bool hasKernel(const KernelAttrs &kernelAttrs) const
+        {
+            return kernels.find(kernelAttrs) != kernels.end();
+        }
         Kernel *getKernel(const KernelAttrs &kernelAttrs) const
         {
             auto it = kernels.find(kernelAttrs);
@@ -20,6 +20,8 @@ namespace infini
             Div,
             Mul,
             MatMul,
+            QuantizedMatMul,
+            QuantizeLinear,
             Relu,
             Sub,
             Transpose,
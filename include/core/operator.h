@@ -11,6 +11,7 @@ namespace infini
     class OperatorObj : public Object
     {
         friend class GraphObj;
+        friend class GraphRewriter;
 
     protected:
         OpType type;
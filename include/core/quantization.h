@@ -0,0 +1,55 @@
+#pragma once
+#include "core/graph.h"
+#include <unordered_map>
+
+namespace infini
+{
+    // The data of the non-constant float32 inputs of a graph for one run
+    using CalibrationSample = std::unordered_map<Tensor, vector<float>>;
+
+    /**
+     * @brief The error that quantizing one MatMul introduces on its output,
+     * measured on the calibration samples with the same float inputs as the
+     * original MatMul, so that the errors of earlier layers do not add up.
+     */
+    struct LayerQuantizationError
+    {
+        Operator original;  // the MatMul of the float graph
+        Operator quantized; // the QuantizedMatmul that replaces it
+        float maxAbsError;
+        float rmsError;
+        // rmsError over the root mean square of the original outputs
+        float relativeError;
+
+        std::string toString() const;
+    };
+
+    struct QuantizationResult
+    {
+        Graph graph;
+        // the tensors of 'graph' that stand for those of the float graph,
+        // e.g. to set its inputs and read its outputs
+        std::unordered_map<Tensor, Tensor> tensors;
+        vector<LayerQuantizationError> layers;
+    };
+
+    /**
+     * @brief Post-training int8 quantization of the MatMuls of a float32
+     * graph whose B input is a constant (a weight, see
+     * GraphObj::setConstant) and which have no fused epilogue and a single B.
+     *
+     * 'graph' must be allocated with its constants holding their data.
+     * Its other inputs are set from every calibration sample in turn and the
+     * graph is run to collect the range of the A input of those MatMuls.
+     *
+     * The result is a new, allocated graph in which each of them becomes a
+     * QuantizeLinear of A, asymmetric per tensor over the calibrated range,
+     * and a QuantizedMatmul with B quantized symmetrically per output
+     * channel, whose output is dequantized to float32. The other operators
+     * are cloned, so the new graph has the same inputs and outputs, and its
+     * weights, float or int8, are constants too.
+     */
+    QuantizationResult quantizeGraph(const Graph &graph,
+                                     const vector<CalibrationSample> &calibration);
+
+} // namespace infini
@@ -0,0 +1,61 @@
+#pragma once
+#include "core/graph_rewriter.h"
+
+namespace infini
+{
+    /**
+     * @brief Rules that evaluate the operators whose inputs are all constants
+     * (see GraphObj::setConstant) once, replacing their outputs with new
+     * constants, so that they are not run any more.
+     */
+    vector<RewriteRule> constantFoldingRules();
+
+    /**
+     * @brief Algebraic simplifications: chains of Relus and Clips become one
+     * clamp, a Clip to [0, +inf) becomes a Relu, and a Clip without bounds,
+     * a cast to the same type, a cast back from an exact widening and the
+     * addition of a constant -0, subtraction of a constant +0 (of any sign
+     * for integers) or multiplication by a constant 1 are removed.
+     */
+    vector<RewriteRule> algebraicRules();
+
+    /**
+     * @brief Rules on transposes: chains of transposes are composed into one,
+     * transposes that leave the data and the shape unchanged are removed, and
+     * a transpose of the last two dims of a MatMul input is folded into
+     * transA or transB.
+     */
+    vector<RewriteRule> transposeRules();
+
+    /**
+     * @brief Rules that move transposes below the operators that work on
+     * every element alone (Relu, Clip, Cast and the binary element-wise
+     * operators), so that they meet other transposes and cancel, or reach a
+     * MatMul and are folded into it.
+     */
+    vector<RewriteRule> transposeSinkingRules();
+
+    /**
+     * @brief Rules that reassociate chains of MatMuls, such as (x * a) * b,
+     * in the order that costs the fewest multiply-adds.
+     */
+    vector<RewriteRule> matmulChainRules();
+
+    /**
+     * @brief Rules that fuse Add(bias), then Relu or Clip, into the epilogue
+     * of the MatMul that produces their input, so that they are applied to
+     * the tiles of C before they are stored.
+     */
+    vector<RewriteRule> matmulEpilogueRules();
+
+    /**
+     * @brief Rules that fuse MatMuls reading the same A, with Bs of the same
+     * shape but for the columns of C, into one MatMul with all their Bs and
+     * outputs, which runs as a single GEMM with a wider n.
+     */
+    vector<RewriteRule> horizontalFusionRules();
+
+    // The rules that GraphObj::optimize applies
+    vector<RewriteRule> defaultRewriteRules();
+
+} // namespace infini
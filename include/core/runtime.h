@@ -29,17 +29,46 @@ namespace infini
   {
   protected:
     Device device;
+    // Alignment in bytes of the memory returned by alloc() and of every tensor
+    // placed in it. It defaults to a cache line, which is also the width of
+    // the widest (AVX-512) vector registers.
+    size_t alignment;
+    // Threads the kernels may split an operator across. 0 stands for the
+    // OpenMP default, e.g. OMP_NUM_THREADS.
+    int numThreads = 0;
 
   public:
-    explicit RuntimeObj(Device device)
-        : device(device) {}
+    explicit RuntimeObj(Device device, size_t alignment = 64)
+        : device(device), alignment(alignment)
+    {
+      IT_ASSERT(alignment >= sizeof(uint64_t) &&
+                    (alignment & (alignment - 1)) == 0,
+                "Alignment should be a power of 2 no less than 8");
+    }
     RuntimeObj(RuntimeObj &other) = delete;
     RuntimeObj &operator=(RuntimeObj const &) = delete;
     virtual ~RuntimeObj() {}
 
     virtual void run(const Graph &graph) const = 0;
+    /**
+     * @brief Allocates 'alignment' aligned memory. The memory is not
+     * initialized.
+     */
     virtual void *alloc(size_t size) = 0;
     virtual void dealloc(void *ptr) = 0;
+    size_t getAlignment() const { return alignment; }
+    /**
+     * @brief Limits the threads used by the kernels. 0 restores the OpenMP
+     * default.
+     */
+    void setNumThreads(int threads)
+    {
+      IT_ASSERT(threads >= 0);
+      numThreads = threads;
+    }
+    // The number of threads a kernel may use, at least 1
+    int getNumThreads() const;
+    Device getDevice() const { return device; }
 
     bool isCpu() const
     {
@@ -53,6 +82,8 @@ namespace infini
   {
   public:
     NativeCpuRuntimeObj() : RuntimeObj(Device::CPU) {}
+    explicit NativeCpuRuntimeObj(size_t alignment)
+        : RuntimeObj(Device::CPU, alignment) {}
 
     static Ref<NativeCpuRuntimeObj> &getInstance()
     {
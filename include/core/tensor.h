@@ -15,6 +15,7 @@ namespace infini
     class TensorObj : public Object
     {
         friend class GraphObj;
+        friend class GraphRewriter;
 
     protected:
         int dim;
@@ -24,6 +25,8 @@ namespace infini
         WRef<OperatorObj> source;
         Blob data;
         Runtime runtime;
+        // See GraphObj::setConstant
+        bool constant = false;
 
     private:
         Shape shape;
@@ -43,6 +46,7 @@ namespace infini
         void setShape(Shape shape_);
         size_t getRank() const { return shape.size(); }
         UidBaseType getFuid() const { return fuid; }
+        bool isConstant() const { return constant; }
 
         void setData(
             std::function<void(void *, size_t, DataType)> const &generator) const;
@@ -122,20 +126,22 @@ namespace infini
                     if (a[i] != b[i])
                         return false;
                 }
-                else if constexpr (std::is_floating_point_v<T>)
+                else if constexpr (std::is_floating_point_v<T> ||
+                                   is_half_v<T>)
                 {
-                    if (std::min(fabs(a[i]), fabs(b[i])) == 0. &&
-                        fabs(a[i] - b[i]) > relativeError)
+                    // half types are compared in fp32
+                    double x = a[i], y = b[i];
+                    if (std::min(fabs(x), fabs(y)) == 0. &&
+                        fabs(x - y) > relativeError)
                     {
-                        printf("Error on %lu: %f %f\n", i, a[i], b[i]);
+                        printf("Error on %lu: %f %f\n", i, x, y);
                         return false;
                     }
-                    else if (std::min(fabs(a[i]), fabs(b[i])) != 0. &&
-                             fabs(a[i] - b[i]) /
-                                     std::max(fabs(a[i]), fabs(b[i])) >
+                    else if (std::min(fabs(x), fabs(y)) != 0. &&
+                             fabs(x - y) / std::max(fabs(x), fabs(y)) >
                                  relativeError)
                     {
-                        printf("Error on %lu: %f %f\n", i, a[i], b[i]);
+                        printf("Error on %lu: %f %f\n", i, x, y);
                         return false;
                     }
                 }
@@ -15,6 +15,10 @@ namespace infini
         // oppsite to the column-major BLAS.
         bool transA, transB;
 
+        // An epilogue fused by the optimizer: C is clipped to [clipMin,
+        // clipMax] after the bias is added. A missing bound is infinite.
+        std::optional<float> clipMin, clipMax;
+
         // Auxiliary attributes which are not a part of operator attributes.
         int m, n, k;
 
@@ -37,8 +41,23 @@ namespace infini
          * the constructor, C should be an empty Ref.
          * @param transA If matrix A should be transposed when computing.
          * @param transB If matrix B should be transposed when computing.
+         * @param bias An optional tensor added to C, which is broadcast to the
+         * shape of C like the inputs of an element-wise operator.
          */
         MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C,
+                  bool transA = false, bool transB = false,
+                  Tensor bias = nullptr);
+        /**
+         * @brief Matmul of A with several Bs, as fused by the optimizer from
+         * MatMuls sharing A: output i is op(A) * op(Bs[i]). The Bs must have
+         * the same dims but for the columns of the outputs; they are the
+         * column slices of one B, which is multiplied by a single GEMM that
+         * reads every slice and writes every output in place.
+         *
+         * @param outputs The outputs. If they are going to be created in the
+         * constructor, they should be Bs.size() empty Refs.
+         */
+        MatmulObj(GraphObj *graph, Tensor A, TensorVec Bs, TensorVec outputs,
                   bool transA = false, bool transB = false);
         OP_CLONE(MatmulObj);
 
@@ -46,12 +65,24 @@ namespace infini
         optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
 
         int numInputs() const override { return inputs.size(); }
-        int numOutputs() const override { return 1; }
+        int numOutputs() const override { return outputs.size(); }
 
         bool getTransA() const { return transA; }
         bool getTransB() const { return transB; }
         void setTransA(bool transA) { this->transA = transA; }
         void setTransB(bool transB) { this->transB = transB; }
+        // The number of Bs, which is that of the outputs
+        size_t numWeights() const { return outputs.size(); }
+        bool hasBias() const { return inputs.size() > 1 + numWeights(); }
+        std::optional<float> getClipMin() const { return clipMin; }
+        std::optional<float> getClipMax() const { return clipMax; }
+        void setClip(std::optional<float> min, std::optional<float> max)
+        {
+            clipMin = min;
+            clipMax = max;
+        }
+        // Whether the output goes through an epilogue after the product
+        bool hasEpilogue() const { return hasBias() || clipMin || clipMax; }
         int getM() const { return m; }
         int getN() const { return n; }
         int getK() const { return k; }
@@ -0,0 +1,52 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini
+{
+    /**
+     * @brief Affine quantization of an int8 tensor, real = scale * (q -
+     * zeroPoint). A single scale and zero point cover the whole tensor; the B
+     * operand of QuantizedMatmulObj may instead have one per column of the
+     * output (per channel).
+     */
+    struct QuantParams
+    {
+        vector<float> scales;
+        vector<int> zeroPoints;
+
+        QuantParams(float scale = 1.f, int zeroPoint = 0)
+            : scales{scale}, zeroPoints{zeroPoint} {}
+        QuantParams(vector<float> scales, vector<int> zeroPoints)
+            : scales(std::move(scales)), zeroPoints(std::move(zeroPoints)) {}
+
+        size_t size() const { return scales.size(); }
+        bool isValid() const;
+        std::string toString() const;
+    };
+
+    /**
+     * @brief Quantizes a float32 tensor to int8 per tensor, q =
+     * saturate(round(x / scale) + zeroPoint), rounding halves to even.
+     *
+     */
+    class QuantizeLinearObj : public OperatorObj
+    {
+    private:
+        QuantParams quant;
+
+    public:
+        QuantizeLinearObj(GraphObj *graph, Tensor input, Tensor output,
+                          QuantParams quant);
+        OP_CLONE(QuantizeLinearObj);
+
+        std::string toString() const override;
+        optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+        vector<DataType> inferDataType(const TensorVec &inputs) const override;
+
+        int numInputs() const override { return 1; }
+        int numOutputs() const override { return 1; }
+
+        const QuantParams &getQuant() const { return quant; }
+    };
+
+} // namespace infini
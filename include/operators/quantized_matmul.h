@@ -0,0 +1,65 @@
+#pragma once
+#include "operators/quantize_linear.h"
+
+namespace infini
+{
+    /**
+     * @brief Matrix multiplication of int8 tensors with int32 accumulation,
+     * C = dequant(A) * dequant(B). The result is either requantized to int8
+     * with the parameters of C, or dequantized to float32 when C has none.
+     *
+     */
+    class QuantizedMatmulObj : public OperatorObj
+    {
+    private:
+        // The same layout and batch broadcast as MatmulObj
+        bool transA, transB;
+        QuantParams aQuant, bQuant;
+        optional<QuantParams> cQuant;
+
+    public:
+        /**
+         * @brief Construct a new QuantizedMatmul object.
+         *
+         * @param graph The computation graph that this operator belongs to.
+         * @param A The int8 input tensor.
+         * @param B The int8 input tensor, usually the weights.
+         * @param C The output tensor, int8 when cQuant is given and float32
+         * otherwise. It should be an empty Ref if outputs are going to be
+         * created in the constructor.
+         * @param aQuant The per-tensor quantization of A.
+         * @param bQuant The per-tensor or per-channel quantization of B.
+         * @param cQuant The per-tensor quantization of C, or nullopt to
+         * dequantize it.
+         * @param transA If matrix A should be transposed when computing.
+         * @param transB If matrix B should be transposed when computing.
+         */
+        QuantizedMatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C,
+                           QuantParams aQuant, QuantParams bQuant,
+                           optional<QuantParams> cQuant = std::nullopt,
+                           bool transA = false, bool transB = false);
+        OP_CLONE(QuantizedMatmulObj);
+
+        std::string toString() const override;
+        optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+        vector<DataType> inferDataType(const TensorVec &inputs) const override;
+
+        int numInputs() const override { return 2; }
+        int numOutputs() const override { return 1; }
+
+        bool getTransA() const { return transA; }
+        bool getTransB() const { return transB; }
+        const QuantParams &getAQuant() const { return aQuant; }
+        const QuantParams &getBQuant() const { return bQuant; }
+        const optional<QuantParams> &getCQuant() const { return cQuant; }
+
+        /**
+         * @brief The largest k whose sums of (A - aZero) * (B - bZero) fit in
+         * int32. A product is at most 255 * 128 in magnitude when B is
+         * symmetric (all its zero points are 0) and 255 * 255 otherwise.
+         */
+        size_t getMaxK() const { return maxK(bQuant); }
+        static size_t maxK(const QuantParams &bQuant);
+    };
+
+} // namespace infini
@@ -27,6 +27,13 @@ namespace infini
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
     std::vector<int> getPermute() const { return transposePermute; }
+    // The permutation must keep the output shape
+    void setPermute(vector<int> permute);
+    /**
+     * @brief Whether the transpose only moves size-1 dims, so that the
+     * elements keep their order and the output is a relabel of the input.
+     */
+    bool isRelabel() const;
 
   private:
     vector<int> transposePermute;
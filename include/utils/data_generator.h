@@ -1,26 +1,42 @@
 #pragma once
 #include "core/common.h"
+#include "core/data_type.h"
 #include <random>
 
 namespace infini {
 
+// The element types of ArithmeticDTypes, which the generators can fill
+#define FOR_EACH_GENERATOR_TYPE(MACRO)                                         \
+    MACRO(float)                                                               \
+    MACRO(int8_t)                                                              \
+    MACRO(int32_t)                                                             \
+    MACRO(int64_t)                                                             \
+    MACRO(float16_t)                                                           \
+    MACRO(double)                                                              \
+    MACRO(uint32_t)                                                            \
+    MACRO(bfloat16_t)
+
 class DataGenerator {
   private:
-    virtual void fill(uint32_t *data, size_t size) { IT_TODO_HALT(); }
-    virtual void fill(float *data, size_t size) { IT_TODO_HALT(); }
+#define DECLARE_FILL(T)                                                        \
+    virtual void fill(T *data, size_t size) { IT_TODO_HALT(); }
+    FOR_EACH_GENERATOR_TYPE(DECLARE_FILL)
+#undef DECLARE_FILL
 
 public:
     virtual ~DataGenerator() {}
     void operator()(void *data, size_t size, DataType dataType) {
-        if (dataType == DataType::UInt32)
-            fill(reinterpret_cast<uint32_t *>(data), size);
-        else if (dataType == DataType::Float32)
-            fill(reinterpret_cast<float *>(data), size);
-        else
-            IT_TODO_HALT();
+        dispatchDType(dataType, ArithmeticDTypes(), [&](auto tag) {
+            using T = typename decltype(tag)::type;
+            fill(reinterpret_cast<T *>(data), size);
+        });
     }
 };
 
+// Overrides every fill of DataGenerator with the template fill<T>
+#define OVERRIDE_FILL(T)                                                       \
+    void fill(T *data, size_t size) override { fill<T>(data, size); }
+
 class IncrementalGenerator : public DataGenerator {
   public:
     virtual ~IncrementalGenerator() {}
@@ -28,14 +44,11 @@ class IncrementalGenerator : public DataGenerator {
   private:
     template <typename T> void fill(T *data, size_t size) {
         for (size_t i = 0; i < size; i++) {
-            data[i] = i;
+            data[i] = T(i);
         }
     }
 
-    void fill(uint32_t *data, size_t size) override {
-        fill<uint32_t>(data, size);
-    }
-    void fill(float *data, size_t size) override { fill<float>(data, size); }
+    FOR_EACH_GENERATOR_TYPE(OVERRIDE_FILL)
 };
 
 template <int val> class ValGenerator : public DataGenerator {
@@ -45,15 +58,15 @@ template <int val> class ValGenerator : public DataGenerator {
   private:
     template <typename T> void fill(T *data, size_t size) {
         for (size_t i = 0; i < size; i++) {
-            data[i] = val;
+            data[i] = T(val);
         }
     }
 
-    void fill(uint32_t *data, size_t size) override {
-        fill<uint32_t>(data, size);
-    }
-    void fill(float *data, size_t size) override { fill<float>(data, size); }
+    FOR_EACH_GENERATOR_TYPE(OVERRIDE_FILL)
 };
 typedef ValGenerator<1> OneGenerator;
 typedef ValGenerator<0> ZeroGenerator;
+
+#undef OVERRIDE_FILL
+#undef FOR_EACH_GENERATOR_TYPE
 } // namespace infini
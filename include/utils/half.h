@@ -0,0 +1,147 @@
+#pragma once
+#ifndef HALF_H
+#define HALF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace infini {
+
+// Conversions between fp32 and the bit patterns of fp16 and bf16, rounding to
+// nearest even like the F16C instructions. NaNs stay (quiet) NaNs.
+
+inline uint32_t floatBits(float x) {
+    uint32_t u;
+    std::memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+inline float bitsFloat(uint32_t u) {
+    float x;
+    std::memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+inline uint16_t floatToHalf(float x) {
+    uint32_t u = floatBits(x);
+    uint32_t sign = (u >> 16) & 0x8000;
+    u &= 0x7fffffff;
+    uint16_t ans;
+    if (u >= 0x47800000) {
+        // overflow to inf, or inf/NaN
+        ans = u > 0x7f800000 ? 0x7e00 | ((u >> 13) & 0x3ff) : 0x7c00;
+    } else if (u < 0x38800000) {
+        // subnormal or zero: let the fp32 adder round the mantissa
+        ans = floatBits(bitsFloat(u) + 0.5f) - 0x3f000000;
+    } else {
+        uint32_t mantOdd = (u >> 13) & 1;
+        u += 0xc8000fff + mantOdd; // rebias the exponent by 15 - 127
+        ans = u >> 13;
+    }
+    return ans | sign;
+}
+
+inline float halfToFloat(uint16_t h) {
+    uint32_t u = uint32_t(h & 0x7fff) << 13;
+    uint32_t exp = u & 0x0f800000;
+    u += 0x38000000; // rebias the exponent by 127 - 15
+    if (exp == 0x0f800000) {
+        u += 0x38000000; // inf/NaN
+        if (u & 0x007fffff)
+            u |= 0x00400000;
+    } else if (exp == 0) {
+        u = floatBits(bitsFloat(u + 0x00800000) - bitsFloat(0x38800000));
+    }
+    return bitsFloat(u | uint32_t(h & 0x8000) << 16);
+}
+
+inline uint16_t floatToBFloat16(float x) {
+    uint32_t u = floatBits(x);
+    if ((u & 0x7fffffff) > 0x7f800000)
+        return (u >> 16) | 0x40;
+    return (u + 0x7fff + ((u >> 16) & 1)) >> 16;
+}
+
+inline float bfloat16ToFloat(uint16_t b) { return bitsFloat(uint32_t(b) << 16); }
+
+/**
+ * @brief The storage types of Float16 and BFloat16 tensors. They convert
+ * implicitly to and from float, so any arithmetic on them is done in fp32 and
+ * rounded to the nearest even 16-bit value when stored back.
+ */
+struct float16_t {
+    uint16_t bits;
+
+    float16_t() = default;
+    float16_t(float x) : bits(floatToHalf(x)) {}
+    operator float() const { return halfToFloat(bits); }
+    static float16_t fromBits(uint16_t bits) {
+        float16_t ans;
+        ans.bits = bits;
+        return ans;
+    }
+};
+
+struct bfloat16_t {
+    uint16_t bits;
+
+    bfloat16_t() = default;
+    bfloat16_t(float x) : bits(floatToBFloat16(x)) {}
+    operator float() const { return bfloat16ToFloat(bits); }
+    static bfloat16_t fromBits(uint16_t bits) {
+        bfloat16_t ans;
+        ans.bits = bits;
+        return ans;
+    }
+};
+
+static_assert(sizeof(float16_t) == 2 && sizeof(bfloat16_t) == 2);
+
+template <typename T>
+inline constexpr bool is_half_v =
+    std::is_same_v<T, float16_t> || std::is_same_v<T, bfloat16_t>;
+
+// Convert n values between fp32 and fp16/bf16 with the widest vectors that
+// the CPU supports (F16C for fp16). The results are the same as those of the
+// scalar conversions above.
+void convertToFloat(const float16_t *src, float *dst, size_t n);
+void convertToFloat(const bfloat16_t *src, float *dst, size_t n);
+void convertFromFloat(const float *src, float16_t *dst, size_t n);
+void convertFromFloat(const float *src, bfloat16_t *dst, size_t n);
+
+} // namespace infini
+
+// The limits used by the kernels, e.g. infinity() for a missing Clip bound
+#define HALF_LIMITS(T, MAX_BITS, MIN_BITS, EPSILON_BITS, DIGITS)               \
+    template <> class std::numeric_limits<infini::T> {                         \
+      public:                                                                  \
+        static constexpr bool is_specialized = true;                           \
+        static constexpr bool is_signed = true;                                \
+        static constexpr bool is_integer = false;                              \
+        static constexpr bool has_infinity = true;                             \
+        static constexpr bool has_quiet_NaN = true;                            \
+        static constexpr int digits = DIGITS;                                  \
+        static infini::T max() { return infini::T::fromBits(MAX_BITS); }       \
+        static infini::T lowest() {                                            \
+            return infini::T::fromBits(MAX_BITS | 0x8000);                     \
+        }                                                                      \
+        static infini::T min() { return infini::T::fromBits(MIN_BITS); }       \
+        static infini::T epsilon() {                                           \
+            return infini::T::fromBits(EPSILON_BITS);                          \
+        }                                                                      \
+        static infini::T infinity() {                                          \
+            return infini::T::fromBits(MAX_BITS + 1);                          \
+        }                                                                      \
+        static infini::T quiet_NaN() {                                         \
+            return infini::T::fromBits((MAX_BITS + 1) | (MAX_BITS + 1) >> 1); \
+        }                                                                      \
+    };
+
+HALF_LIMITS(float16_t, 0x7bff, 0x0400, 0x1400, 11)
+HALF_LIMITS(bfloat16_t, 0x7f7f, 0x0080, 0x3c00, 8)
+#undef HALF_LIMITS
+
+#endif
@@ -18,6 +18,30 @@ Shape locate_index(size_t inputN, const Shape &shape);
 // Delocate the ShapeIndex from Shape with broadcast
 size_t delocate_index(const Shape &shapeIndex, const Shape &shape,
                       const Shape &stride);
+
+// A broadcast binary operation C = f(A, B), simplified for iteration: the
+// size-1 dims of C are dropped and neighbouring dims that A and B broadcast
+// the same way are merged. An input's stride is 0 along the dims it is
+// broadcast on.
+struct BroadcastInfo {
+    enum Kind {
+        Same,    // A, B and C have the same shape
+        ScalarA, // A has a single element
+        ScalarB,
+        RowA,    // dims is {rows, cols} and A is a single row
+        RowB,
+        ColumnA, // dims is {rows, cols} and A is a single column
+        ColumnB,
+        General,
+    } kind;
+    Shape dims;
+    vector<size_t> strideA, strideB;
+};
+// Classify the broadcast from A and B to their broadcast shape C
+BroadcastInfo analyze_broadcast(const Shape &A, const Shape &B, const Shape &C);
+// Offsets of the matrices of a MatMul operand with 'dims' for every batch of
+// the output 'cDims', following the batch broadcast of MatmulObj::inferShape
+vector<size_t> matmul_batch_offsets(const Shape &dims, const Shape &cDims);
 // Convert KernelAttrs to a string representation
 std::string get_kernel_attrs_str(const KernelAttrs &kernelAttrs);
 
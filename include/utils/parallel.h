@@ -0,0 +1,39 @@
+#pragma once
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "core/runtime.h"
+#include <algorithm>
+
+namespace infini {
+
+// Elements below which a task is not worth a thread: the fork and join cost
+// more than the work.
+constexpr size_t PARALLEL_GRAIN = 1 << 15;
+
+/**
+ * @brief Splits [0, n) into contiguous ranges of at least 'grain' items and
+ * calls f(begin, end) for each of them, on at most context->getNumThreads()
+ * threads. Runs f(0, n) on the calling thread when there is too little work.
+ */
+template <typename F>
+void parallelFor(const RuntimeObj *context, size_t n, size_t grain, F &&f) {
+    size_t tasks = std::min<size_t>(context->getNumThreads(),
+                                    n / std::max(grain, size_t(1)));
+    if (tasks <= 1) {
+        if (n > 0)
+            f(size_t(0), n);
+        return;
+    }
+    size_t chunk = (n + tasks - 1) / tasks;
+#pragma omp parallel for num_threads(tasks) schedule(static, 1)
+    for (long task = 0; task < long(tasks); ++task) {
+        size_t begin = task * chunk, end = std::min(n, begin + chunk);
+        if (begin < end)
+            f(begin, end);
+    }
+}
+
+} // namespace infini
+
+#endif
@@ -0,0 +1,270 @@
+#pragma once
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "utils/half.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+// The library is built for the baseline ISA of the target, so the CPU kernels
+// compile their vector paths for a specific ISA with the attributes below and
+// choose one at run time with cpuIsa().
+#if defined(__x86_64__) || defined(__i386__)
+#define IT_X86 1
+#include <immintrin.h>
+#define IT_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#define IT_TARGET_AVX512                                                       \
+    __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma,f16c")))
+#define IT_TARGET_AVX512_VNNI                                                  \
+    __attribute__((target(                                                     \
+        "avx512f,avx512bw,avx512dq,avx512vl,avx512vnni,avx2,fma,f16c")))
+#else
+#define IT_X86 0
+#endif
+
+// The generic vector loops are inlined into the ISA-specific callers, where
+// the intrinsics of their Vec are allowed.
+#define IT_ALWAYS_INLINE inline __attribute__((always_inline))
+
+namespace infini {
+
+enum class CpuIsa { Scalar, Avx2, Avx512 };
+
+/**
+ * @brief The widest vector ISA supported by the CPU. It can be lowered with
+ * the environment variable INFINI_CPU_ISA (scalar, avx2 or avx512), e.g. to
+ * test the narrower paths.
+ */
+inline CpuIsa cpuIsa() {
+    static const CpuIsa isa = [] {
+        auto isa = CpuIsa::Scalar;
+#if IT_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+            __builtin_cpu_supports("f16c"))
+            isa = CpuIsa::Avx2;
+        if (isa == CpuIsa::Avx2 && __builtin_cpu_supports("avx512f") &&
+            __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512dq") &&
+            __builtin_cpu_supports("avx512vl"))
+            isa = CpuIsa::Avx512;
+#endif
+        if (const char *env = std::getenv("INFINI_CPU_ISA")) {
+            if (std::strcmp(env, "scalar") == 0)
+                isa = CpuIsa::Scalar;
+            else if (std::strcmp(env, "avx2") == 0 && isa == CpuIsa::Avx512)
+                isa = CpuIsa::Avx2;
+        }
+        return isa;
+    }();
+    return isa;
+}
+
+/**
+ * @brief Whether the AVX-512 VNNI int8 dot products can be used, i.e. cpuIsa()
+ * is Avx512 and the CPU has them.
+ */
+inline bool cpuHasAvx512Vnni() {
+    static const bool vnni = [] {
+#if IT_X86
+        return cpuIsa() == CpuIsa::Avx512 &&
+               __builtin_cpu_supports("avx512vnni");
+#else
+        return false;
+#endif
+    }();
+    return vnni;
+}
+
+/**
+ * @brief Vector types for the generic loops below. An op used with them is a
+ * functor with a templated scalar operator() and an overload for each vector
+ * type it accelerates.
+ */
+template <typename T> struct ScalarVec {
+    using V = T;
+    static constexpr size_t width = 1;
+    static V load(const T *p) { return *p; }
+    static void store(T *p, V v) { *p = v; }
+    static V set1(T x) { return x; }
+};
+
+#if IT_X86
+struct Avx2Float {
+    using V = __m256;
+    static constexpr size_t width = 8;
+    IT_TARGET_AVX2 static V load(const float *p) { return _mm256_loadu_ps(p); }
+    IT_TARGET_AVX2 static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+    IT_TARGET_AVX2 static V set1(float x) { return _mm256_set1_ps(x); }
+};
+
+struct Avx512Float {
+    using V = __m512;
+    static constexpr size_t width = 16;
+    IT_TARGET_AVX512 static V load(const float *p) {
+        return _mm512_loadu_ps(p);
+    }
+    IT_TARGET_AVX512 static void store(float *p, V v) {
+        _mm512_storeu_ps(p, v);
+    }
+    IT_TARGET_AVX512 static V set1(float x) { return _mm512_set1_ps(x); }
+};
+#endif
+
+// The loops pass vectors by value in functions without a target attribute,
+// which GCC flags as an ABI change, but they are always inlined into callers
+// of the right target. GCC 12 also warns about the _mm512_undefined_*
+// placeholders inside the AVX-512 intrinsics.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+// y[i] = op(x[i]). y may alias x.
+template <typename Vec, typename T, typename Op>
+IT_ALWAYS_INLINE void unaryLoop(const T *x, T *y, size_t n, const Op &op) {
+    size_t i = 0;
+    for (; i + Vec::width <= n; i += Vec::width)
+        Vec::store(y + i, op(Vec::load(x + i)));
+    for (; i < n; ++i)
+        y[i] = op(x[i]);
+}
+
+// c[i] = op(a[i * strideA], b[i * strideB]) with strides of 0 or 1. c may
+// alias an input whose stride is 1.
+template <typename Vec, typename T, typename Op>
+IT_ALWAYS_INLINE void binaryLoop(const T *a, size_t strideA, const T *b,
+                                 size_t strideB, T *c, size_t n,
+                                 const Op &op) {
+    size_t i = 0;
+    if (strideA && strideB) {
+        for (; i + Vec::width <= n; i += Vec::width)
+            Vec::store(c + i, op(Vec::load(a + i), Vec::load(b + i)));
+        for (; i < n; ++i)
+            c[i] = op(a[i], b[i]);
+    } else if (strideA) {
+        T y = *b;
+        auto vy = Vec::set1(y);
+        for (; i + Vec::width <= n; i += Vec::width)
+            Vec::store(c + i, op(Vec::load(a + i), vy));
+        for (; i < n; ++i)
+            c[i] = op(a[i], y);
+    } else if (strideB) {
+        T x = *a;
+        auto vx = Vec::set1(x);
+        for (; i + Vec::width <= n; i += Vec::width)
+            Vec::store(c + i, op(vx, Vec::load(b + i)));
+        for (; i < n; ++i)
+            c[i] = op(x, b[i]);
+    } else {
+        T z = op(*a, *b);
+        for (; i < n; ++i)
+            c[i] = z;
+    }
+}
+
+#if IT_X86
+template <typename Vec, typename T, typename Op>
+IT_TARGET_AVX2 void unaryLoopAvx2(const T *x, T *y, size_t n, const Op &op) {
+    unaryLoop<Vec>(x, y, n, op);
+}
+
+template <typename Vec, typename T, typename Op>
+IT_TARGET_AVX512 void unaryLoopAvx512(const T *x, T *y, size_t n,
+                                      const Op &op) {
+    unaryLoop<Vec>(x, y, n, op);
+}
+
+template <typename Vec, typename T, typename Op>
+IT_TARGET_AVX2 void binaryLoopAvx2(const T *a, size_t strideA, const T *b,
+                                   size_t strideB, T *c, size_t n,
+                                   const Op &op) {
+    binaryLoop<Vec>(a, strideA, b, strideB, c, n, op);
+}
+
+template <typename Vec, typename T, typename Op>
+IT_TARGET_AVX512 void binaryLoopAvx512(const T *a, size_t strideA, const T *b,
+                                       size_t strideB, T *c, size_t n,
+                                       const Op &op) {
+    binaryLoop<Vec>(a, strideA, b, strideB, c, n, op);
+}
+#endif
+
+#pragma GCC diagnostic pop
+
+// fp16 and bf16 are computed in fp32 on chunks of this many elements, widened
+// into buffers on the stack, which stay in L1.
+constexpr size_t HALF_CHUNK = 512;
+
+/**
+ * @brief y[i] = op(x[i]) on the widest vectors that cpuIsa() allows for T.
+ */
+template <typename T, typename Op>
+void vectorizedUnary(const T *x, T *y, size_t n, const Op &op) {
+    if constexpr (is_half_v<T>) {
+        float buffer[HALF_CHUNK];
+        for (size_t i = 0; i < n; i += HALF_CHUNK) {
+            size_t len = std::min(HALF_CHUNK, n - i);
+            convertToFloat(x + i, buffer, len);
+            vectorizedUnary(buffer, buffer, len, op);
+            convertFromFloat(buffer, y + i, len);
+        }
+        return;
+    }
+#if IT_X86
+    if constexpr (std::is_same_v<T, float>) {
+        switch (cpuIsa()) {
+        case CpuIsa::Avx512:
+            return unaryLoopAvx512<Avx512Float>(x, y, n, op);
+        case CpuIsa::Avx2:
+            return unaryLoopAvx2<Avx2Float>(x, y, n, op);
+        default:
+            break;
+        }
+    }
+#endif
+    unaryLoop<ScalarVec<T>>(x, y, n, op);
+}
+
+/**
+ * @brief c[i] = op(a[i * strideA], b[i * strideB]), where a stride of 0
+ * broadcasts a single element, on the widest vectors that cpuIsa() allows for
+ * T.
+ */
+template <typename T, typename Op>
+void vectorizedBinary(const T *a, size_t strideA, const T *b, size_t strideB,
+                      T *c, size_t n, const Op &op) {
+    if constexpr (is_half_v<T>) {
+        float bufferA[HALF_CHUNK], bufferB[HALF_CHUNK], bufferC[HALF_CHUNK];
+        for (size_t i = 0; i < n; i += HALF_CHUNK) {
+            size_t len = std::min(HALF_CHUNK, n - i);
+            // a broadcast input is a single element
+            convertToFloat(a + i * strideA, bufferA, strideA ? len : 1);
+            convertToFloat(b + i * strideB, bufferB, strideB ? len : 1);
+            vectorizedBinary(bufferA, strideA, bufferB, strideB, bufferC, len,
+                             op);
+            convertFromFloat(bufferC, c + i, len);
+        }
+        return;
+    }
+#if IT_X86
+    if constexpr (std::is_same_v<T, float>) {
+        switch (cpuIsa()) {
+        case CpuIsa::Avx512:
+            return binaryLoopAvx512<Avx512Float>(a, strideA, b, strideB, c, n,
+                                                 op);
+        case CpuIsa::Avx2:
+            return binaryLoopAvx2<Avx2Float>(a, strideA, b, strideB, c, n, op);
+        default:
+            break;
+        }
+    }
+#endif
+    binaryLoop<ScalarVec<T>>(a, strideA, b, strideB, c, n, op);
+}
+
+} // namespace infini
+
+#endif
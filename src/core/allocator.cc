@@ -1,4 +1,6 @@
 #include "core/allocator.h"
+#include <algorithm>
+#include <iterator>
 #include <utility>
 
 namespace infini
@@ -9,10 +11,11 @@ namespace infini
         peak = 0;
         ptr = nullptr;
 
-        // 'alignment' defaults to sizeof(uint64_t), because it is the length of
-        // the longest data type currently supported by the DataType field of
-        // the tensor
-        alignment = sizeof(uint64_t);
+        // Every tensor starts at a multiple of the runtime alignment, which is
+        // also the alignment of the memory returned by runtime->alloc. It is
+        // at least sizeof(uint64_t), the length of the longest data type
+        // currently supported by the DataType field of the tensor.
+        alignment = runtime->getAlignment();
     }
 
     Allocator::~Allocator()
@@ -32,35 +35,23 @@ namespace infini
         // =================================== 作业 ===================================
         // TODO: 设计一个算法来分配内存，返回起始地址偏移量
         // =================================== 作业 ===================================
-        auto target{recycle_map_.end()};
-        for (auto it = recycle_map_.begin(); it != recycle_map_.end(); ++it) {
-            if (it->second >= size) {
-                // valid block
-                if (target == recycle_map_.end()) {
-                    // the first available block
-                    target = it;
-                } else if (target->second > it->second) {
-                    // try to find the smallest block
-                    target = it;
-                }
-            }
-        }
-
-        size_t addr{0};
-        if (target != recycle_map_.end()) {
-            // alloc from recycled blocks
-            addr = target->first + target->second - size;
-            target->second -= size;
-            if (target->second == 0) {
-                recycle_map_.erase(target);
+        // best fit: the smallest free block that can hold 'size'
+        auto fit = freeBlocksBySize_.lower_bound({size, 0});
+        if (fit != freeBlocksBySize_.end())
+        {
+            auto [blockSize, addr] = *fit;
+            eraseFreeBlock(freeBlocks_.find(addr));
+            if (blockSize > size)
+            {
+                insertFreeBlock(addr + size, blockSize - size);
             }
-        } else {
-            // alloc from raw memory bank
-            addr = used;
-            used += size;
+            return addr;
         }
 
-        peak = used;
+        // alloc from raw memory bank
+        size_t addr = used;
+        used += size;
+        peak = std::max(peak, used);
         return addr;
     }
 
@@ -72,22 +63,38 @@ namespace infini
         // =================================== 作业 ===================================
         // TODO: 设计一个算法来回收内存
         // =================================== 作业 ===================================
-                recycle_map_.insert(std::make_pair(addr, size));
-        // try to merge recycled blocks
-        // time complexity O(n)
-        for (auto it = recycle_map_.begin(); it != recycle_map_.end();) {
-            auto found{recycle_map_.find(it->first + it->second)};
-            if(found != recycle_map_.end()) {
-                it->second += found->second;
-                recycle_map_.erase(found);
-            } else if (it->first + it->second == used) {
-                used -= it->second;
-                it = recycle_map_.erase(it);
-            } else {
-                ++it;
+        // merge with the free blocks right before and right after this one
+        auto next = freeBlocks_.lower_bound(addr);
+        if (next != freeBlocks_.begin())
+        {
+            auto prev = std::prev(next);
+            IT_ASSERT(prev->first + prev->second <= addr, "Double free");
+            if (prev->first + prev->second == addr)
+            {
+                addr = prev->first;
+                size += prev->second;
+                eraseFreeBlock(prev);
             }
         }
-        peak = used;
+        if (next != freeBlocks_.end())
+        {
+            IT_ASSERT(addr + size <= next->first, "Double free");
+            if (addr + size == next->first)
+            {
+                size += next->second;
+                eraseFreeBlock(next);
+            }
+        }
+
+        // a free block at the end of the memory bank is given back to it
+        if (addr + size == used)
+        {
+            used = addr;
+        }
+        else
+        {
+            insertFreeBlock(addr, size);
+        }
     }
 
     void *Allocator::getPtr()
@@ -102,7 +109,20 @@ namespace infini
 
     size_t Allocator::getAlignedSize(size_t size)
     {
-        return ((size - 1) / this->alignment + 1) * this->alignment;
+        // alignment is a power of 2
+        return (size + this->alignment - 1) & ~(this->alignment - 1);
+    }
+
+    void Allocator::insertFreeBlock(size_t addr, size_t size)
+    {
+        freeBlocks_.emplace(addr, size);
+        freeBlocksBySize_.emplace(size, addr);
+    }
+
+    void Allocator::eraseFreeBlock(std::map<size_t, size_t>::iterator it)
+    {
+        freeBlocksBySize_.erase({it->second, it->first});
+        freeBlocks_.erase(it);
     }
 
     void Allocator::info()
@@ -0,0 +1,14 @@
+#include "core/blob.h"
+#include "core/runtime.h"
+
+namespace infini {
+
+BlobObj::BlobObj(Runtime runtime, size_t size)
+    : runtime(runtime), ptr(runtime->alloc(size)), owned(true) {}
+
+BlobObj::~BlobObj() {
+    if (owned)
+        runtime->dealloc(ptr);
+}
+
+} // namespace infini
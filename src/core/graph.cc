@@ -1,9 +1,11 @@
 #include "core/graph.h"
 #include "core/common.h"
+#include "core/kernel.h"
 #include "core/op_type.h"
+#include "core/rewrite_rules.h"
 #include "core/runtime.h"
+#include "operators/concat.h"
 #include "operators/transpose.h"
-#include "operators/matmul.h"
 #include <algorithm>
 #include <cstddef>
 #include <numeric>
@@ -71,164 +73,94 @@ namespace infini
         {
             return true;
         }
-        std::vector<Operator> sorted;
-        std::unordered_set<OperatorObj *> flags;
-        sorted.reserve(ops.size());
-        flags.reserve(ops.size());
-        while (sorted.size() < ops.size())
+        // Kahn's algorithm, which keeps the current order of the operators
+        // that do not depend on each other. pending counts the inputs of an
+        // operator whose source has not been sorted yet.
+        std::unordered_map<OperatorObj *, size_t> pending;
+        pending.reserve(ops.size());
+        for (auto const &op : ops)
+        {
+            pending[op.get()] = 0;
+        }
+        for (auto const &op : ops)
         {
-            // Any node is move to sorted in this loop.
-            auto modified = false;
-            for (auto const &op : ops)
+            for (auto const &input : op->getInputs())
             {
-                if (auto const &inputs = op->getInputs();
-                    flags.find(op.get()) == flags.end() &&
-                    std::all_of(inputs.begin(), inputs.end(),
-                                [&flags](auto const &input)
-                                {
-                                    auto ptr = input->getSource().get();
-                                    return !ptr || flags.find(ptr) != flags.end();
-                                }))
+                if (auto source = input->getSource();
+                    source && pending.count(source.get()))
                 {
-                    modified = true;
-                    sorted.emplace_back(op);
-                    flags.insert(op.get());
+                    ++pending[op.get()];
                 }
             }
-            if (!modified)
+        }
+        std::vector<Operator> sorted;
+        sorted.reserve(ops.size());
+        for (auto const &op : ops)
+        {
+            if (pending[op.get()] == 0)
+            {
+                sorted.emplace_back(op);
+            }
+        }
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            // copied, since 'sorted' grows in the loop
+            auto op = sorted[i];
+            for (auto const &output : op->getOutputs())
             {
-                return false;
+                // a target is listed once per input that reads 'output', and
+                // may read other outputs of 'op' too
+                std::unordered_set<OperatorObj *> visited;
+                for (auto const &target : output->getTargets())
+                {
+                    auto it = pending.find(target.get());
+                    if (it == pending.end() || !visited.insert(target.get()).second)
+                    {
+                        continue;
+                    }
+                    // a target may read the output through several inputs
+                    for (auto const &input : target->getInputs())
+                    {
+                        if (input == output)
+                        {
+                            --it->second;
+                        }
+                    }
+                    if (it->second == 0)
+                    {
+                        sorted.emplace_back(target);
+                    }
+                }
             }
         }
+        if (sorted.size() < ops.size())
+        {
+            return false;
+        }
         this->ops = std::move(sorted);
         return this->sorted = true;
     }
 
     void GraphObj::optimize()
     {
-        // =================================== 作业 ===================================
-        // TODO: 设计一个算法来实现指定的图优化规则
-        // 图优化规则如下：
-        // 1. 去除冗余的算子（例如，两个相邻的算子都是 transpose 算子，且做的是相反的操作，可以将其全部删除）
-        // 2. 合并算子（例如，矩阵乘算子中含有属性transA、transB，如果其输入存在transpose，且对最后两个维度做交换，就可以将transpose融入到矩阵乘算子的属性中去）
-        // =================================== 作业 ===================================
-        if (ops.empty()) {
+        if (ops.empty())
+        {
             return;
         }
-
         IT_ASSERT(topo_sort() == true);
-        bool optimized_this_pass{false};
-        for (size_t i = 0; i < ops.size();) {
-            optimized_this_pass = false;
-            auto& op{ops.at(i)};
-            // rule 1, 2
-            if (op->type == OpType::Transpose) {
-                const auto& perm{as<TransposeObj>(op)->getPermute()};
-                for (auto& succ: op->successors) {
-                    auto succ_ptr{succ.lock()};
-                    if (!succ_ptr) {
-                        continue;
-                    }
-
-                    // rule 1
-                    if (succ_ptr->type == OpType::Transpose) {
-                        const auto& succ_perm{as<TransposeObj>(succ_ptr)->getPermute()};
-                        if (perm == succ_perm) {
-                            for (auto& succ2: succ_ptr->successors) {
-                                auto succ2_ptr{succ2.lock()};
-                                if (!succ2_ptr) {
-                                    continue;
-                                }
-
-                                // release tensor
-                                for (auto t: op->outputs) {
-                                    removeTensor(t);
-                                }
-                                for (auto t: succ_ptr->outputs) {
-                                    removeTensor(t);
-                                }
-
-                                // reconnect
-                                for (size_t i = 0; i < succ2_ptr->inputs.size(); ++i) {
-                                    if (succ2_ptr->inputs[i] == succ_ptr->outputs[0]) {
-                                        succ2_ptr->inputs[i] = op->inputs[0];
-                                    }
-                                }
-                                for (auto& input: succ2_ptr->inputs) {
-                                    input->removeTarget(op);
-                                    input->addTarget(succ2_ptr);
-                                }
-                                succ2_ptr->removePredecessors(succ_ptr);
-                            }
-
-                            // remove from ops
-                            for (auto it = ops.begin(); it != ops.end();) {
-                                if (*it == op) {
-                                    ops.erase(it);
-                                    break;
-                                } else {
-                                    ++it;
-                                }
-                            }
-
-                            for (auto it = ops.begin(); it != ops.end();) {
-                                if (*it == succ_ptr) {
-                                    ops.erase(it);
-                                    break;
-                                } else {
-                                    ++it;
-                                }
-                            }
-                            // The graph structure has been modified, we optimize from the begining
-                            i = 0;
-                            optimized_this_pass = true;
-                        }
-                    } else if (succ_ptr->type == OpType::MatMul) {
-                        // rule 2
-                        if ((perm.at(perm.size() - 1) == static_cast<int>(perm.size()) - 2) &&
-                            (perm.at(perm.size() - 2) == static_cast<int>(perm.size()) - 1)) {
-                            // can been trans
-                            if (op->outputs[0] == succ_ptr->inputs[0]) {
-                                // trans A
-                                as<MatmulObj>(succ_ptr)->setTransA(true);
-                                succ_ptr->inputs[0] = op->inputs[0];
-                                succ_ptr->inputs[0]->removeTarget(op);
-                                succ_ptr->inputs[0]->addTarget(succ_ptr);
-                            } else {
-                                // trans B
-                                as<MatmulObj>(succ_ptr)->setTransB(true);
-                                succ_ptr->inputs[1] = op->inputs[0];
-                                succ_ptr->inputs[1]->removeTarget(op);
-                                succ_ptr->inputs[1]->addTarget(succ_ptr);
-                            }
-                            // release tensor
-                            removeTensor(op->outputs[0]);
-                            // reconnect
-                            succ_ptr->removePredecessors(op);
-
-                            // remove from ops
-                            for (auto it = ops.begin(); it != ops.end();) {
-                                if (*it == op) {
-                                    ops.erase(it);
-                                    break;
-                                } else {
-                                    ++it;
-                                }
-                            }
-                            // The graph structure has been modified, we optimize from the begining
-                            i = 0;
-                            optimized_this_pass = true;
-                        }
-                    }
-                }
-            }
+        GraphRewriter(this).run(defaultRewriteRules());
+        IT_ASSERT(topo_sort() == true);
+    }
 
-            if(!optimized_this_pass) {
-                ++i;
-            }
+    void GraphObj::setConstant(const Tensor &tensor)
+    {
+        IT_ASSERT(!tensor->getSource(), "A constant cannot have a source");
+        if (tensor->isConstant())
+        {
+            return;
         }
-
-        IT_ASSERT(topo_sort() == true);
+        tensor->constant = true;
+        tensor->setDataBlob(make_ref<BlobObj>(runtime, tensor->getBytes()));
     }
 
     Tensor GraphObj::getTensor(int fuid) const
@@ -266,7 +198,7 @@ namespace infini
         }
     }
 
-    void GraphObj::dataMalloc()
+    void GraphObj::dataMalloc(bool inplace, bool zeroCopyConcat)
     {
         // topological sorting first
         IT_ASSERT(topo_sort() == true);
@@ -275,17 +207,190 @@ namespace infini
         // TODO：利用 allocator 给计算图分配内存
         // HINT: 获取分配好的内存指针后，可以调用 tensor 的 setDataBlob 函数给 tensor 绑定内存
         // =================================== 作业 ===================================
-        size_t size{0};
-        for (auto tensor: tensors) {
-            size += tensor->getBytes();
+        // Simulate the run on the allocator: a tensor is allocated when its
+        // source is executed and freed right after its last target, so the
+        // arena only needs to hold the tensors alive at the same time. Graph
+        // inputs and outputs are pinned for the whole run. Constants keep the
+        // memory they got in setConstant.
+        //
+        // A block of the arena is shared by several tensors when an operator
+        // runs in place or when a concat input is placed in the concat output,
+        // and is freed when the last of them dies.
+        struct Block
+        {
+            size_t offset, size, refs;
+        };
+        vector<Block> blocks;
+        // tensor -> (block, offset in the block)
+        std::unordered_map<TensorObj *, pair<size_t, size_t>> placeOf;
+        std::unordered_map<TensorObj *, size_t> pendingReads;
+        for (auto &op : ops)
+        {
+            for (auto &input : op->getInputs())
+            {
+                ++pendingReads[input.get()];
+            }
         }
+        auto isPinned = [](const Tensor &tensor)
+        {
+            return !tensor->getSource() || tensor->getTargets().empty();
+        };
 
-        allocator.alloc(size);
-        size_t offset{0};
-        for (auto tensor: tensors) {
-            tensor->setDataBlob(make_ref<BlobObj>(runtime,
-                reinterpret_cast<void*>(reinterpret_cast<char*>(allocator.getPtr()) + offset)));
-            offset += tensor->getBytes();
+        // A concat input that is only read by the concat is written by its
+        // source directly to its slice of the concat output, which is
+        // contiguous when all the dimensions before the concat axis are 1.
+        // The concat kernel skips the inputs that are already in place.
+        // tensor -> (concat output, offset in the concat output)
+        std::unordered_map<TensorObj *, pair<Tensor, size_t>> sliceOf;
+        for (auto &op : ops)
+        {
+            if (!zeroCopyConcat || op->getOpType() != OpType::Concat)
+            {
+                continue;
+            }
+            auto output = op->getOutput();
+            auto dims = output->getDims();
+            auto dim = as<ConcatObj>(op)->getDim();
+            if (std::accumulate(dims.begin(), dims.begin() + dim, 1,
+                                std::multiplies{}) != 1)
+            {
+                continue;
+            }
+            size_t offset = 0;
+            for (auto &input : op->getInputs())
+            {
+                if (input->getSource() && input->getTargets().size() == 1 &&
+                    !sliceOf.count(input.get()) &&
+                    offset % allocator.getAlignment() == 0)
+                {
+                    sliceOf.emplace(input.get(), pair{output, offset});
+                }
+                offset += input->getBytes();
+            }
+        }
+
+        std::function<void(const Tensor &)> place = [&](const Tensor &tensor)
+        {
+            if (auto it = sliceOf.find(tensor.get()); it != sliceOf.end())
+            {
+                auto &[concatOutput, offset] = it->second;
+                if (!placeOf.count(concatOutput.get()))
+                {
+                    place(concatOutput);
+                }
+                auto [block, base] = placeOf.at(concatOutput.get());
+                placeOf[tensor.get()] = {block, base + offset};
+                ++blocks[block].refs;
+            }
+            else
+            {
+                auto size = tensor->getBytes();
+                placeOf[tensor.get()] = {blocks.size(), 0};
+                blocks.push_back({allocator.alloc(size), size, 1});
+            }
+        };
+        auto release = [&](const Tensor &tensor)
+        {
+            auto &block = blocks[placeOf.at(tensor.get()).first];
+            if (--block.refs == 0)
+            {
+                allocator.free(block.offset, block.size);
+            }
+        };
+        // the input whose memory 'op' can overwrite with its output, if any
+        const auto &kernelRegistry = KernelRegistry::getInstance();
+        auto getInplaceInput = [&](const Operator &op) -> Tensor
+        {
+            auto kernelAttrs =
+                KernelAttrs{runtime->getDevice(), op->getOpType().underlying()};
+            if (!inplace || op->numOutputs() != 1 ||
+                sliceOf.count(op->getOutput().get()) ||
+                !kernelRegistry.hasKernel(kernelAttrs) ||
+                !kernelRegistry.getKernel(kernelAttrs)->supportInplace())
+            {
+                return nullptr;
+            }
+            const auto &inputs = op->getInputs();
+            auto output = op->getOutput();
+            for (auto &input : inputs)
+            {
+                size_t reads = std::count(inputs.begin(), inputs.end(), input);
+                if (!isPinned(input) && pendingReads[input.get()] == reads &&
+                    input->getDims() == output->getDims() &&
+                    input->getBytes() == output->getBytes() &&
+                    blocks[placeOf.at(input.get()).first].refs == 1)
+                {
+                    return input;
+                }
+            }
+            return nullptr;
+        };
+
+        // the input whose dims 'op' only relabels: a transpose that moves
+        // size-1 dims shares the memory of its input and copies nothing. The
+        // shared block stops any in-place writer while both are alive.
+        auto getRelabeledInput = [&](const Operator &op) -> Tensor
+        {
+            if (!inplace || op->getOpType() != OpType::Transpose ||
+                sliceOf.count(op->getOutput().get()) ||
+                op->getInputs(0)->isConstant() ||
+                !as<TransposeObj>(op)->isRelabel())
+            {
+                return nullptr;
+            }
+            return op->getInputs(0);
+        };
+
+        for (auto &tensor : tensors)
+        {
+            if (!tensor->getSource() && !tensor->isConstant())
+            {
+                place(tensor);
+            }
+        }
+        for (auto &op : ops)
+        {
+            auto input = getRelabeledInput(op);
+            if (!input)
+            {
+                input = getInplaceInput(op);
+            }
+            if (input)
+            {
+                auto where = placeOf.at(input.get());
+                placeOf[op->getOutput().get()] = where;
+                ++blocks[where.first].refs;
+            }
+            else
+            {
+                for (auto &output : op->getOutputs())
+                {
+                    // a concat output is placed with its first input
+                    if (!placeOf.count(output.get()))
+                    {
+                        place(output);
+                    }
+                }
+            }
+            for (auto &input : op->getInputs())
+            {
+                if (--pendingReads[input.get()] == 0 && !isPinned(input))
+                {
+                    release(input);
+                }
+            }
+        }
+
+        auto base = reinterpret_cast<char *>(allocator.getPtr());
+        for (auto &tensor : tensors)
+        {
+            if (tensor->isConstant())
+            {
+                continue;
+            }
+            auto [block, offset] = placeOf.at(tensor.get());
+            tensor->setDataBlob(make_ref<BlobObj>(
+                runtime, base + blocks[block].offset + offset));
         }
 
         allocator.info();
@@ -0,0 +1,229 @@
+#include "core/graph_rewriter.h"
+#include <algorithm>
+
+namespace infini
+{
+
+    GraphRewriter::GraphRewriter(GraphObj *graph) : graph(graph)
+    {
+        for (auto &tensor : graph->getTensors())
+        {
+            if (tensor->getTargets().empty())
+                graphOutputs.insert(tensor.get());
+            else if (!tensor->getSource())
+                readInputs.insert(tensor.get());
+        }
+    }
+
+    size_t GraphRewriter::run(const vector<RewriteRule> &rules)
+    {
+        std::unordered_map<OpType::underlying_t, vector<const RewriteRule *>>
+            rulesOf;
+        for (auto &rule : rules)
+            rulesOf[rule.pattern.type.underlying()].push_back(&rule);
+
+        IT_ASSERT(graph->topo_sort());
+        for (auto &op : graph->getOperators())
+            enqueue(op);
+
+        size_t applied = 0;
+        Match match;
+        while (!worklist.empty())
+        {
+            auto op = std::move(worklist.front());
+            worklist.pop_front();
+            queued.erase(op.get());
+            if (isRemoved(op))
+                continue;
+            auto it = rulesOf.find(op->getOpType().underlying());
+            if (it == rulesOf.end())
+                continue;
+            for (auto rule : it->second)
+            {
+                match.clear();
+                if (!this->match(rule->pattern, op, match) ||
+                    !rule->rewrite(*this, match))
+                    continue;
+                ++applied;
+                touch(op);
+                flushTouched();
+                break;
+            }
+        }
+        compact();
+        return applied;
+    }
+
+    bool GraphRewriter::match(const Pattern &pattern, const Operator &op,
+                              Match &ans) const
+    {
+        if (op->getOpType() != pattern.type ||
+            (pattern.predicate && !pattern.predicate(op)))
+            return false;
+        ans.push_back(op);
+        for (auto &[index, inputPattern] : pattern.inputs)
+        {
+            if (index >= op->getInputs().size())
+                return false;
+            auto source = op->getInputs(index)->getSource();
+            if (!source)
+                return false;
+            if (inputPattern.singleUse)
+            {
+                for (auto &output : source->getOutputs())
+                {
+                    auto targets = output->getTargets();
+                    if (isGraphOutput(output) ||
+                        std::any_of(targets.begin(), targets.end(),
+                                    [&](auto &target)
+                                    { return target != op; }))
+                        return false;
+                }
+            }
+            if (!match(inputPattern, source, ans))
+                return false;
+        }
+        return true;
+    }
+
+    void GraphRewriter::enqueue(const Operator &op)
+    {
+        if (!isRemoved(op) && queued.insert(op.get()).second)
+            worklist.push_back(op);
+    }
+
+    void GraphRewriter::touch(const Operator &op)
+    {
+        if (op)
+            touched.push_back(op);
+    }
+
+    void GraphRewriter::flushTouched()
+    {
+        while (!touched.empty())
+        {
+            auto op = std::move(touched.back());
+            touched.pop_back();
+            if (isRemoved(op))
+                continue;
+            auto &outputs = op->getOutputs();
+            if (std::all_of(outputs.begin(), outputs.end(),
+                            [&](auto &output)
+                            {
+                                return output->getTargets().empty() &&
+                                       !isGraphOutput(output);
+                            }))
+            {
+                // removing it touches its producers
+                removeOperator(op);
+                continue;
+            }
+            enqueue(op);
+            for (auto &pred : op->getPredecessors())
+                enqueue(pred);
+            for (auto &succ : op->getSuccessors())
+                enqueue(succ);
+        }
+    }
+
+    void GraphRewriter::relinkPredecessors(const Operator &op)
+    {
+        for (auto &pred : op->getPredecessors())
+            pred->removeSuccessors(op);
+        op->predecessors.clear();
+        for (auto &input : op->getInputs())
+        {
+            auto source = input->getSource();
+            if (source && std::none_of(op->predecessors.begin(),
+                                       op->predecessors.end(),
+                                       [&](auto &pred)
+                                       { return pred.lock() == source; }))
+            {
+                op->addPredecessors(source);
+                source->addSuccessors(op);
+            }
+        }
+    }
+
+    void GraphRewriter::replaceInput(const Operator &op, size_t index,
+                                     const Tensor &tensor)
+    {
+        auto from = op->getInputs(index);
+        if (from == tensor)
+            return;
+        op->inputs[index] = tensor;
+        // a tensor has one target entry per input that reads it
+        from->removeTarget(op);
+        for (auto &input : op->getInputs())
+            if (input == from)
+                from->addTarget(op);
+        tensor->addTarget(op);
+        relinkPredecessors(op);
+        touch(from->getSource());
+        touch(tensor->getSource());
+        touch(op);
+    }
+
+    void GraphRewriter::replaceAllUses(const Tensor &from, const Tensor &to)
+    {
+        IT_ASSERT(!isGraphOutput(from), "Cannot replace a graph output");
+        // the targets change while they are rewired
+        auto targets = from->getTargets();
+        for (auto &target : targets)
+        {
+            auto &inputs = target->getInputs();
+            for (size_t i = 0; i < inputs.size(); ++i)
+                if (inputs[i] == from)
+                    replaceInput(target, i, to);
+        }
+    }
+
+    void GraphRewriter::removeOperator(const Operator &op)
+    {
+        if (isRemoved(op))
+            return;
+        for (auto &output : op->getOutputs())
+            IT_ASSERT(output->getSource() != op ||
+                          (output->getTargets().empty() && !isGraphOutput(output)),
+                      "Cannot remove an operator whose outputs are read");
+        for (auto &input : op->getInputs())
+        {
+            input->removeTarget(op);
+            touch(input->getSource());
+        }
+        for (auto &pred : op->getPredecessors())
+            pred->removeSuccessors(op);
+        for (auto &succ : op->getSuccessors())
+            succ->removePredecessors(op);
+        op->predecessors.clear();
+        op->successors.clear();
+        removed.insert(op.get());
+        removedOps.push_back(op);
+    }
+
+    void GraphRewriter::compact()
+    {
+        if (removed.empty() && graph->sorted)
+            return;
+        auto &ops = graph->ops;
+        ops.erase(std::remove_if(ops.begin(), ops.end(),
+                                 [&](auto &op)
+                                 { return isRemoved(op); }),
+                  ops.end());
+        auto &tensors = graph->tensors;
+        tensors.erase(std::remove_if(tensors.begin(), tensors.end(),
+                                     [&](auto &tensor)
+                                     {
+                                         if (auto source = tensor->getSource())
+                                             return isRemoved(source);
+                                         // an input unread from the start is
+                                         // kept for the user to set
+                                         return tensor->getTargets().empty() &&
+                                                (tensor->isConstant() ||
+                                                 readInputs.count(tensor.get()));
+                                     }),
+                      tensors.end());
+        graph->sorted = false;
+    }
+
+} // namespace infini
@@ -0,0 +1,298 @@
+#include "core/quantization.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+#include "operators/quantized_matmul.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <unordered_set>
+
+namespace infini
+{
+
+    namespace
+    {
+        // Runs the operators of an allocated graph one by one and calls
+        // observe(op) after each of them, while its inputs and outputs still
+        // hold their data.
+        template <typename F>
+        void runObserved(const Graph &graph, F &&observe)
+        {
+            auto runtime = graph->getRuntime();
+            const auto &kernelRegistry = KernelRegistry::getInstance();
+            for (auto &op : graph->getOperators())
+            {
+                auto kernelAttrs =
+                    KernelAttrs{runtime->getDevice(), op->getOpType().underlying()};
+                kernelRegistry.getKernel(kernelAttrs)->compute(op, runtime.get());
+                observe(op);
+            }
+        }
+
+        void setSample(const CalibrationSample &sample)
+        {
+            for (auto &[tensor, data] : sample)
+            {
+                IT_ASSERT(tensor->getDType() == DataType::Float32 &&
+                          tensor->size() == data.size());
+                std::copy(data.begin(), data.end(),
+                          tensor->getRawDataPtr<float *>());
+            }
+        }
+
+        // Asymmetric quantization of [lo, hi], widened to contain 0 so that
+        // zeros stay exact
+        QuantParams activationQuant(float lo, float hi)
+        {
+            lo = std::min(lo, 0.f);
+            hi = std::max(hi, 0.f);
+            float scale = hi > lo ? (hi - lo) / 255.f : 1.f;
+            float zeroPoint = std::nearbyint(-128.f - lo / scale);
+            return QuantParams(scale, int(std::clamp(zeroPoint, -128.f, 127.f)));
+        }
+
+        /**
+         * @brief Symmetric per-channel quantization of the B input of a
+         * MatMul, to [-127, 127] with one scale per column of the output.
+         */
+        pair<QuantParams, vector<int8_t>> quantizeWeight(const Ref<MatmulObj> &op)
+        {
+            auto B = op->getInputs(1);
+            const auto &dims = B->getDims();
+            size_t rows = dims[dims.size() - 2], cols = dims.back();
+            size_t n = op->getTransB() ? rows : cols;
+            auto data = B->getRawDataPtr<float *>();
+            // the channel of every element of B, across all its batches
+            auto channelOf = [&](size_t i)
+            { return op->getTransB() ? i / cols % rows : i % cols; };
+
+            vector<float> maxAbs(n, 0.f);
+            for (size_t i = 0; i < B->size(); ++i)
+            {
+                auto &m = maxAbs[channelOf(i)];
+                m = std::max(m, std::abs(data[i]));
+            }
+            QuantParams quant(vector<float>(n), vector<int>(n, 0));
+            for (size_t j = 0; j < n; ++j)
+                quant.scales[j] = maxAbs[j] > 0 ? maxAbs[j] / 127.f : 1.f;
+            vector<int8_t> weight(B->size());
+            for (size_t i = 0; i < B->size(); ++i)
+            {
+                float q = std::nearbyint(data[i] / quant.scales[channelOf(i)]);
+                weight[i] = int8_t(std::clamp(q, -127.f, 127.f));
+            }
+            return {quant, weight};
+        }
+
+        /**
+         * @brief The quantization of one MatMul and a graph that runs it
+         * alone on float inputs, to measure its error.
+         */
+        struct QuantizedLayer
+        {
+            Ref<MatmulObj> original;
+            float lo = std::numeric_limits<float>::infinity();
+            float hi = -std::numeric_limits<float>::infinity();
+            QuantParams aQuant, bQuant;
+            vector<int8_t> weight;
+
+            Graph probe;
+            Tensor probeInput, probeOutput;
+            double sumSquaredError = 0, sumSquaredOutput = 0;
+            float maxAbsError = 0;
+            size_t count = 0;
+
+            void buildProbe(const Runtime &runtime)
+            {
+                probe = make_ref<GraphObj>(runtime);
+                auto A = original->getInputs(0), B = original->getInputs(1);
+                probeInput = probe->addTensor(A->getDims(), DataType::Float32);
+                auto w = probe->addTensor(B->getDims(), DataType::Int8);
+                auto q = probe->addOp<QuantizeLinearObj>(probeInput, nullptr,
+                                                         aQuant);
+                probeOutput =
+                    probe->addOp<QuantizedMatmulObj>(
+                             q->getOutput(), w, nullptr, aQuant, bQuant,
+                             std::nullopt, original->getTransA(),
+                             original->getTransB())
+                        ->getOutput();
+                probe->dataMalloc();
+                std::copy(weight.begin(), weight.end(),
+                          w->getRawDataPtr<int8_t *>());
+            }
+
+            // Runs the probe on the current input of the original MatMul and
+            // compares it with the current output
+            void measure()
+            {
+                auto A = original->getInputs(0);
+                std::memcpy(probeInput->getRawDataPtr<void *>(),
+                            A->getRawDataPtr<void *>(), A->getBytes());
+                probe->getRuntime()->run(probe);
+                auto ref = original->getOutput()->getRawDataPtr<float *>();
+                auto out = probeOutput->getRawDataPtr<float *>();
+                for (size_t i = 0; i < probeOutput->size(); ++i)
+                {
+                    float error = out[i] - ref[i];
+                    sumSquaredError += double(error) * error;
+                    sumSquaredOutput += double(ref[i]) * ref[i];
+                    maxAbsError = std::max(maxAbsError, std::abs(error));
+                }
+                count += probeOutput->size();
+            }
+        };
+    } // namespace
+
+    std::string LayerQuantizationError::toString() const
+    {
+        std::ostringstream os;
+        os << "MatMul[" << original->getGuid() << "] -> QuantizedMatMul["
+           << quantized->getGuid() << "]: maxAbsError=" << maxAbsError
+           << ", rmsError=" << rmsError << ", relativeError=" << relativeError;
+        return os.str();
+    }
+
+    QuantizationResult quantizeGraph(const Graph &graph,
+                                     const vector<CalibrationSample> &calibration)
+    {
+        IT_ASSERT(!calibration.empty(), "Quantization needs calibration data");
+        IT_ASSERT(graph->topo_sort());
+        auto runtime = graph->getRuntime();
+
+        // the MatMuls with float inputs and a constant B
+        std::unordered_map<OperatorObj *, QuantizedLayer> layers;
+        for (auto &op : graph->getOperators())
+        {
+            if (op->getOpType() != OpType::MatMul)
+                continue;
+            auto matmul = as<MatmulObj>(op);
+            auto A = op->getInputs(0), B = op->getInputs(1);
+            size_t k = matmul->getTransA() ? A->getDims()[A->getRank() - 2]
+                                           : A->getDims().back();
+            // a fused bias or clip is not part of the quantized MatMul, which
+            // has a single B. The weights are quantized symmetrically, see
+            // quantizeWeight.
+            if (!matmul->hasEpilogue() && matmul->numOutputs() == 1 &&
+                A->getDType() == DataType::Float32 &&
+                B->getDType() == DataType::Float32 && B->isConstant() &&
+                k <= QuantizedMatmulObj::maxK(QuantParams()))
+                layers[op.get()].original = matmul;
+        }
+
+        // calibrate the ranges of A
+        for (auto &sample : calibration)
+        {
+            setSample(sample);
+            runObserved(graph, [&](const Operator &op)
+                        {
+                auto it = layers.find(op.get());
+                if (it == layers.end())
+                    return;
+                auto A = op->getInputs(0);
+                auto data = A->getRawDataPtr<float *>();
+                auto [lo, hi] = std::minmax_element(data, data + A->size());
+                it->second.lo = std::min(it->second.lo, *lo);
+                it->second.hi = std::max(it->second.hi, *hi); });
+        }
+
+        // quantize, then measure every layer on the same samples
+        for (auto &[_, layer] : layers)
+        {
+            layer.aQuant = activationQuant(layer.lo, layer.hi);
+            std::tie(layer.bQuant, layer.weight) = quantizeWeight(layer.original);
+            layer.buildProbe(runtime);
+        }
+        for (auto &sample : calibration)
+        {
+            setSample(sample);
+            runObserved(graph, [&](const Operator &op)
+                        {
+                if (auto it = layers.find(op.get()); it != layers.end())
+                    it->second.measure(); });
+        }
+
+        // build the quantized graph. A weight keeps a float copy only if an
+        // operator other than a quantized MatMul reads it.
+        QuantizationResult result;
+        result.graph = make_ref<GraphObj>(runtime);
+        std::unordered_set<TensorObj *> floatNeeded;
+        for (auto &op : graph->getOperators())
+        {
+            for (size_t i = 0; i < op->getInputs().size(); ++i)
+            {
+                if (i != 1 || !layers.count(op.get()))
+                    floatNeeded.insert(op->getInputs(i).get());
+            }
+        }
+        for (auto &tensor : graph->getTensors())
+        {
+            if (!tensor->getSource() && !floatNeeded.count(tensor.get()) &&
+                !tensor->getTargets().empty())
+                continue;
+            auto &qTensor = result.tensors[tensor] =
+                result.graph->addTensor(tensor->getDims(), tensor->getDType());
+            if (tensor->isConstant())
+            {
+                result.graph->setConstant(qTensor);
+                std::memcpy(qTensor->getRawDataPtr<void *>(),
+                            tensor->getRawDataPtr<void *>(), tensor->getBytes());
+            }
+        }
+        auto mapped = [&](const TensorVec &tensors)
+        {
+            TensorVec ans;
+            for (auto &tensor : tensors)
+                ans.push_back(result.tensors.at(tensor));
+            return ans;
+        };
+
+        // one QuantizeLinear per activation with its calibrated parameters,
+        // and one int8 copy per weight and channel axis
+        std::unordered_map<TensorObj *, Tensor> quantizedInputs;
+        std::map<pair<TensorObj *, bool>, Tensor> int8Weights;
+        for (auto &op : graph->getOperators())
+        {
+            auto it = layers.find(op.get());
+            if (it == layers.end())
+            {
+                result.graph->cloneOperator(op, mapped(op->getInputs()),
+                                            mapped(op->getOutputs()));
+                continue;
+            }
+            auto &layer = it->second;
+            auto A = op->getInputs(0), B = op->getInputs(1);
+            auto &qA = quantizedInputs[A.get()];
+            if (!qA)
+                qA = result.graph
+                         ->addOp<QuantizeLinearObj>(result.tensors.at(A),
+                                                    nullptr, layer.aQuant)
+                         ->getOutput();
+            auto &qB = int8Weights[{B.get(), layer.original->getTransB()}];
+            if (!qB)
+            {
+                qB = result.graph->addTensor(B->getDims(), DataType::Int8);
+                result.graph->setConstant(qB);
+                std::copy(layer.weight.begin(), layer.weight.end(),
+                          qB->getRawDataPtr<int8_t *>());
+            }
+            auto quantized = result.graph->addOpWithOutputs<QuantizedMatmulObj>(
+                qA, qB, result.tensors.at(op->getOutput()), layer.aQuant,
+                layer.bQuant, std::nullopt, layer.original->getTransA(),
+                layer.original->getTransB());
+
+            double count = std::max(layer.count, size_t(1));
+            float rmsError = std::sqrt(layer.sumSquaredError / count);
+            float rmsOutput = std::sqrt(layer.sumSquaredOutput / count);
+            result.layers.push_back(
+                {op, quantized, layer.maxAbsError, rmsError,
+                 rmsOutput > 0 ? rmsError / rmsOutput : rmsError});
+        }
+
+        result.graph->dataMalloc();
+        return result;
+    }
+
+} // namespace infini
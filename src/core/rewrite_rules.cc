@@ -0,0 +1,869 @@
+#include "core/rewrite_rules.h"
+#include "core/kernel.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include "utils/operator_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace infini
+{
+
+    namespace
+    {
+        // Whether a transpose swaps the last two dims and keeps the others
+        bool swapsLastTwoDims(const Operator &op)
+        {
+            auto perm = as<TransposeObj>(op)->getPermute();
+            int rank = perm.size();
+            if (rank < 2 || perm[rank - 2] != rank - 1 ||
+                perm[rank - 1] != rank - 2)
+                return false;
+            for (int i = 0; i < rank - 2; ++i)
+                if (perm[i] != i)
+                    return false;
+            return true;
+        }
+
+        // Transpose(Transpose(x)) -> Transpose(x) with the composed
+        // permutation. The outer transpose is kept, so that its output may be
+        // a graph output, and the inner one is removed once unread.
+        RewriteRule composeTransposes()
+        {
+            return {"ComposeTransposes",
+                    {OpType::Transpose, nullptr, {{0, {OpType::Transpose}}}},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto outer = as<TransposeObj>(match[0]);
+                        auto inner = as<TransposeObj>(match[1]);
+                        auto perm = outer->getPermute();
+                        auto innerPerm = inner->getPermute();
+                        // output dim i of the pair is input dim innerPerm[perm[i]]
+                        vector<int> composed(perm.size());
+                        for (size_t i = 0; i < perm.size(); ++i)
+                            composed[i] = innerPerm[perm[i]];
+                        rewriter.replaceInput(outer, 0, inner->getInputs(0));
+                        outer->setPermute(composed);
+                        return true;
+                    }};
+        }
+
+        // Whether a transpose only moves size-1 dims and keeps the shape,
+        // which includes the identity permutation
+        bool isIdentityTranspose(const Operator &op)
+        {
+            return as<TransposeObj>(op)->isRelabel() &&
+                   op->getInputs(0)->getDims() == op->getOutput()->getDims();
+        }
+
+        /**
+         * @brief Makes the readers of the output of 'op' read 'input', which
+         * holds the same data, so that 'op' is removed. If the output is a
+         * graph output, the producer of 'input' writes it instead, provided
+         * that 'op' is the only reader of 'input'.
+         */
+        bool bypass(GraphRewriter &rewriter, const Operator &op,
+                    const Tensor &input)
+        {
+            auto output = op->getOutput();
+            if (!rewriter.isGraphOutput(output))
+            {
+                rewriter.replaceAllUses(output, input);
+                return true;
+            }
+            auto source = input->getSource();
+            auto targets = input->getTargets();
+            if (!source || source->numOutputs() != 1 ||
+                rewriter.isGraphOutput(input) || targets.size() != 1 ||
+                targets[0] != op)
+                return false;
+            rewriter.cloneOperator(source, source->getInputs(), {output});
+            rewriter.removeOperator(op);
+            rewriter.removeOperator(source);
+            return true;
+        }
+
+        // Transpose(x) -> x for an identity transpose
+        RewriteRule eliminateIdentityTranspose()
+        {
+            return {"EliminateIdentityTranspose",
+                    {OpType::Transpose, isIdentityTranspose},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        return bypass(rewriter, match[0],
+                                      match[0]->getInputs(0));
+                    }};
+        }
+
+        // MatMul(Transpose(a), b) -> MatMul(a, b) with transA flipped, and
+        // the same for b and transB if it is the only B
+        RewriteRule foldTransposeIntoMatmul(size_t input)
+        {
+            return {input == 0 ? "FoldTransposeIntoMatMulA"
+                               : "FoldTransposeIntoMatMulB",
+                    {OpType::MatMul,
+                     [input](const Operator &op)
+                     { return input == 0 || op->numOutputs() == 1; },
+                     {{input, {OpType::Transpose, swapsLastTwoDims}}}},
+                    [input](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto matmul = as<MatmulObj>(match[0]);
+                        if (input == 0)
+                            matmul->setTransA(!matmul->getTransA());
+                        else
+                            matmul->setTransB(!matmul->getTransB());
+                        rewriter.replaceInput(matmul, input,
+                                              match[1]->getInputs(0));
+                        return true;
+                    }};
+        }
+
+        vector<int> inversePermutation(const vector<int> &perm)
+        {
+            vector<int> ans(perm.size());
+            for (size_t i = 0; i < perm.size(); ++i)
+                ans[perm[i]] = i;
+            return ans;
+        }
+
+        // Identity transposes are removed rather than moved
+        bool isSinkable(const Operator &op) { return !isIdentityTranspose(op); }
+
+        /**
+         * @brief Replaces 'op', which reads the output of 'transpose', with a
+         * copy of it on the input of the transpose followed by the
+         * transpose, which writes the outputs of 'op'. 'inputs' are those of
+         * the copy.
+         */
+        void sinkTranspose(GraphRewriter &rewriter, const Operator &op,
+                           const Ref<TransposeObj> &transpose,
+                           const TensorVec &inputs)
+        {
+            auto output = op->getOutput();
+            auto inner = rewriter.getGraph()->addTensor(
+                transpose->getInputs(0)->getDims(), output->getDType());
+            rewriter.cloneOperator(op, inputs, {inner});
+            rewriter.addOpWithOutputs<TransposeObj>(inner, output,
+                                                    transpose->getPermute());
+            rewriter.removeOperator(op);
+        }
+
+        // Op(Transpose(x)) -> Transpose(Op(x)) for an operator that works on
+        // every element alone
+        RewriteRule sinkTransposeThroughUnary(OpType type)
+        {
+            return {std::string("SinkTransposeThrough") + type.toString(),
+                    {type,
+                     nullptr,
+                     {{0, {OpType::Transpose, isSinkable, {}, true}}}},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto transpose = as<TransposeObj>(match[1]);
+                        sinkTranspose(rewriter, match[0], transpose,
+                                      {transpose->getInputs(0)});
+                        return true;
+                    }};
+        }
+
+        /**
+         * @brief Op(Transpose(x), y) -> Transpose(Op(x, Transpose'(y))) for
+         * a binary element-wise operator, with Transpose' the inverse
+         * permutation, and the same for the second input.
+         *
+         * The transpose is only sunk if it is as large as the output and if
+         * y is cheap to permute: the same transposed tensor, the output of
+         * another transpose, which Transpose' is composed with, or a smaller
+         * tensor that is broadcast. y must have the rank of the output, as
+         * there is no reshape to align it.
+         */
+        RewriteRule sinkTransposeThroughElementWise(OpType type, size_t input)
+        {
+            return {std::string("SinkTransposeThrough") + type.toString() +
+                        std::to_string(input),
+                    {type,
+                     nullptr,
+                     {{input, {OpType::Transpose, isSinkable, {}, true}}}},
+                    [input](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto op = match[0];
+                        auto transpose = as<TransposeObj>(match[1]);
+                        auto transposed = op->getInputs(input);
+                        auto other = op->getInputs(1 - input);
+                        auto output = op->getOutput();
+                        if (transposed->getDims() != output->getDims() ||
+                            other->getRank() != output->getRank())
+                            return false;
+                        TensorVec inputs(2, transpose->getInputs(0));
+                        if (other != transposed)
+                        {
+                            auto source = other->getSource();
+                            if (!(source && source->getOpType() == OpType::Transpose) &&
+                                other->size() >= output->size())
+                                return false;
+                            inputs[1 - input] =
+                                rewriter
+                                    .addOp<TransposeObj>(
+                                        other, nullptr,
+                                        inversePermutation(transpose->getPermute()))
+                                    ->getOutput();
+                        }
+                        sinkTranspose(rewriter, op, transpose, inputs);
+                        return true;
+                    }};
+        }
+
+        // The epilogue rules apply to MatMuls with a single output, whose
+        // epilogue covers exactly the tensor they write
+        bool hasSingleOutput(const Operator &op) { return op->numOutputs() == 1; }
+
+        bool hasNoEpilogue(const Operator &op)
+        {
+            return hasSingleOutput(op) && !as<MatmulObj>(op)->hasEpilogue();
+        }
+
+        /**
+         * @brief The bounds of Clip(Clip(x, lo1, hi1), lo2, hi2) as a single
+         * Clip: those of the inner clip clamped to the outer ones, which
+         * holds even if the ranges do not overlap. A missing bound is
+         * infinite.
+         */
+        pair<optional<float>, optional<float>>
+        composeClips(optional<float> lo1, optional<float> hi1,
+                     optional<float> lo2, optional<float> hi2)
+        {
+            auto clamp = [&](optional<float> bound, optional<float> missing)
+            {
+                if (!bound)
+                    return missing;
+                float val = *bound;
+                if (lo2)
+                    val = std::max(val, *lo2);
+                if (hi2)
+                    val = std::min(val, *hi2);
+                return optional<float>(val);
+            };
+            return {clamp(lo1, lo2), clamp(hi1, hi2)};
+        }
+
+        // Add(MatMul(a, b), bias) -> MatMul(a, b, bias), and the same with
+        // the bias first
+        RewriteRule fuseMatmulBias(size_t input)
+        {
+            return {"FuseMatMulBias" + std::to_string(input),
+                    {OpType::Add,
+                     nullptr,
+                     {{input, {OpType::MatMul, hasNoEpilogue, {}, true}}}},
+                    [input](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto add = match[0], matmul = match[1];
+                        auto product = add->getInputs(input);
+                        auto bias = add->getInputs(1 - input);
+                        // the bias must not broadcast the product
+                        if (bias == product ||
+                            product->getDims() != add->getOutput()->getDims())
+                            return false;
+                        rewriter.cloneOperator(
+                            matmul,
+                            {matmul->getInputs(0), matmul->getInputs(1), bias},
+                            {add->getOutput()});
+                        rewriter.removeOperator(add);
+                        rewriter.removeOperator(matmul);
+                        return true;
+                    }};
+        }
+
+        // Relu(MatMul) and Clip(MatMul) -> MatMul with the clip in its
+        // epilogue, after the bias
+        RewriteRule fuseMatmulClip(OpType type)
+        {
+            return {std::string("FuseMatMul") + type.toString(),
+                    {type,
+                     nullptr,
+                     {{0, {OpType::MatMul, hasSingleOutput, {}, true}}}},
+                    [type](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto op = match[0];
+                        auto matmul = as<MatmulObj>(match[1]);
+                        optional<float> lo = 0.f, hi;
+                        if (type == OpType::Clip)
+                        {
+                            lo = as<ClipObj>(op)->getMin();
+                            hi = as<ClipObj>(op)->getMax();
+                        }
+                        auto fused = as<MatmulObj>(rewriter.cloneOperator(
+                            matmul, matmul->getInputs(), {op->getOutput()}));
+                        auto [min, max] = composeClips(
+                            matmul->getClipMin(), matmul->getClipMax(), lo, hi);
+                        fused->setClip(min, max);
+                        rewriter.removeOperator(op);
+                        rewriter.removeOperator(matmul);
+                        return true;
+                    }};
+        }
+
+        // A MatMul that may be fused with its siblings: a single output and
+        // no bias, and a B that is not computed by the graph, so that the
+        // fused MatMul cannot read its own outputs
+        bool isFusableSibling(const Operator &op)
+        {
+            return hasSingleOutput(op) && !as<MatmulObj>(op)->hasBias() &&
+                   !op->getInputs(1)->getSource();
+        }
+
+        /**
+         * @brief MatMul(a, b1), ..., MatMul(a, bn) -> one MatMul(a, [b1, ...,
+         * bn]) that writes their outputs, so that they run as a single GEMM
+         * over the Bs side by side, which are read in place.
+         *
+         * The MatMuls must have the same transA, transB and clip, and their
+         * Bs the same dtype and dims except for the columns of C.
+         */
+        RewriteRule fuseSiblingMatmuls()
+        {
+            return {"FuseSiblingMatMuls",
+                    {OpType::MatMul, isFusableSibling},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto matmul = as<MatmulObj>(match[0]);
+                        auto a = matmul->getInputs(0), b = matmul->getInputs(1);
+                        int rank = b->getRank();
+                        // the dim of B along the columns of C
+                        int axis = matmul->getTransB() ? rank - 2 : rank - 1;
+                        auto isSibling = [&](const Operator &op)
+                        {
+                            if (op->getOpType() != OpType::MatMul ||
+                                op->getInputs(0) != a || !isFusableSibling(op))
+                                return false;
+                            auto other = as<MatmulObj>(op);
+                            auto otherB = other->getInputs(1);
+                            if (other->getTransA() != matmul->getTransA() ||
+                                other->getTransB() != matmul->getTransB() ||
+                                other->getClipMin() != matmul->getClipMin() ||
+                                other->getClipMax() != matmul->getClipMax() ||
+                                otherB->getDType() != b->getDType() ||
+                                otherB->getRank() != b->getRank())
+                                return false;
+                            auto dims = otherB->getDims();
+                            dims[axis] = b->getDims()[axis];
+                            return dims == b->getDims();
+                        };
+                        OpVec siblings;
+                        for (auto &op : a->getTargets())
+                        {
+                            if (isSibling(op) &&
+                                std::find(siblings.begin(), siblings.end(), op) ==
+                                    siblings.end())
+                                siblings.push_back(op);
+                        }
+                        if (siblings.size() < 2)
+                            return false;
+
+                        TensorVec weights, outputs;
+                        for (auto &op : siblings)
+                        {
+                            weights.push_back(op->getInputs(1));
+                            outputs.push_back(op->getOutput());
+                        }
+                        auto fused = rewriter.addOpWithOutputs<MatmulObj>(
+                            a, weights, outputs, matmul->getTransA(),
+                            matmul->getTransB());
+                        fused->setClip(matmul->getClipMin(), matmul->getClipMax());
+                        for (auto &op : siblings)
+                            rewriter.removeOperator(op);
+                        return true;
+                    }};
+        }
+
+        // An operand of a MatMul chain: a tensor and whether it is
+        // transposed, like A and transA
+        struct ChainOperand
+        {
+            Tensor tensor;
+            bool trans;
+        };
+
+        /**
+         * @brief Whether input 'index' of a chain MatMul is the product of
+         * another MatMul of the chain: one without an epilogue whose output
+         * is read by this input only and is not transposed by it.
+         */
+        bool isChainProduct(GraphRewriter &rewriter, const Ref<MatmulObj> &op,
+                            size_t index)
+        {
+            auto input = op->getInputs(index);
+            auto source = input->getSource();
+            bool trans = index == 0 ? op->getTransA() : op->getTransB();
+            return source && source->getOpType() == OpType::MatMul &&
+                   hasNoEpilogue(source) && !trans &&
+                   !rewriter.isGraphOutput(input) &&
+                   input->getTargets().size() == 1;
+        }
+
+        // Collects the operands of the chain rooted at 'op' from left to
+        // right, and its MatMuls with every MatMul before its inputs
+        void collectChain(GraphRewriter &rewriter, const Ref<MatmulObj> &op,
+                          vector<ChainOperand> &operands, OpVec &ops)
+        {
+            ops.push_back(op);
+            for (size_t index : {0, 1})
+            {
+                if (isChainProduct(rewriter, op, index))
+                    collectChain(rewriter,
+                                 as<MatmulObj>(op->getInputs(index)->getSource()),
+                                 operands, ops);
+                else
+                    operands.push_back(
+                        {op->getInputs(index),
+                         index == 0 ? op->getTransA() : op->getTransB()});
+            }
+        }
+
+        /**
+         * @brief MatMul(MatMul(a, b), c) -> MatMul(a, MatMul(b, c)) and the
+         * like for longer chains: the MatMuls whose intermediate products
+         * are read by the next MatMul only are reassociated in the order
+         * that costs the fewest multiply-adds, found by the classic dynamic
+         * programming over the chain.
+         *
+         * The cost of a product is that of every matrix of its broadcast
+         * batch. The chain is rewritten only if that beats the current
+         * order, and from its last MatMul, which keeps the bias and the clip
+         * of its epilogue.
+         */
+        RewriteRule reorderMatmulChain()
+        {
+            return {"ReorderMatMulChain",
+                    {OpType::MatMul, hasSingleOutput},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto root = as<MatmulObj>(match[0]);
+                        auto output = root->getOutput();
+                        // the chain is rewritten from its last MatMul
+                        auto targets = output->getTargets();
+                        if (targets.size() == 1 &&
+                            targets[0]->getOpType() == OpType::MatMul &&
+                            targets[0]->numOutputs() == 1)
+                        {
+                            auto next = as<MatmulObj>(targets[0]);
+                            for (size_t index : {0, 1})
+                                if (next->getInputs(index) == output &&
+                                    isChainProduct(rewriter, next, index))
+                                    return false;
+                        }
+                        vector<ChainOperand> operands;
+                        OpVec ops;
+                        collectChain(rewriter, root, operands, ops);
+                        size_t n = operands.size();
+                        if (n < 3)
+                            return false;
+
+                        // the rows, columns and batch dims of every operand
+                        vector<double> dims(n + 1);
+                        vector<Shape> batches(n);
+                        for (size_t i = 0; i < n; ++i)
+                        {
+                            auto shape = operands[i].tensor->getDims();
+                            auto rank = shape.size();
+                            if (operands[i].tensor->getDType() !=
+                                operands[0].tensor->getDType())
+                                return false;
+                            size_t rows = shape[rank - 2], cols = shape[rank - 1];
+                            if (operands[i].trans)
+                                std::swap(rows, cols);
+                            if (i == 0)
+                                dims[0] = rows;
+                            dims[i + 1] = cols;
+                            batches[i] = Shape(shape.begin(), shape.end() - 2);
+                        }
+                        // batch[i][j]: the number of matrices in the product
+                        // of operands i to j
+                        vector<vector<double>> batch(n, vector<double>(n));
+                        for (size_t i = 0; i < n; ++i)
+                        {
+                            Shape shape;
+                            for (size_t j = i; j < n; ++j)
+                            {
+                                shape = infer_broadcast(shape, batches[j]);
+                                batch[i][j] = 1;
+                                for (auto dim : shape)
+                                    batch[i][j] *= dim;
+                            }
+                        }
+                        // cost[i][j]: the fewest multiply-adds for the product
+                        // of operands i to j, which splits after split[i][j]
+                        vector<vector<double>> cost(n, vector<double>(n, 0));
+                        vector<vector<size_t>> split(n, vector<size_t>(n));
+                        for (size_t len = 2; len <= n; ++len)
+                        {
+                            for (size_t i = 0, j = len - 1; j < n; ++i, ++j)
+                            {
+                                cost[i][j] = -1;
+                                for (size_t k = i; k < j; ++k)
+                                {
+                                    double c = cost[i][k] + cost[k + 1][j] +
+                                               batch[i][j] * dims[i] *
+                                                   dims[k + 1] * dims[j + 1];
+                                    if (cost[i][j] < 0 || c < cost[i][j])
+                                    {
+                                        cost[i][j] = c;
+                                        split[i][j] = k;
+                                    }
+                                }
+                            }
+                        }
+                        double current = 0;
+                        for (auto &op : ops)
+                        {
+                            auto matmul = as<MatmulObj>(op);
+                            auto a = op->getInputs(0)->getDims();
+                            size_t k = matmul->getTransA() ? a[a.size() - 2]
+                                                           : a.back();
+                            current += double(op->getOutput()->size()) * k;
+                        }
+                        if (cost[0][n - 1] >= current)
+                            return false;
+
+                        std::function<ChainOperand(size_t, size_t)> build =
+                            [&](size_t i, size_t j) -> ChainOperand
+                        {
+                            if (i == j)
+                                return operands[i];
+                            auto lhs = build(i, split[i][j]);
+                            auto rhs = build(split[i][j] + 1, j);
+                            if (i > 0 || j < n - 1)
+                                return {rewriter
+                                            .addOp<MatmulObj>(
+                                                lhs.tensor, rhs.tensor, nullptr,
+                                                lhs.trans, rhs.trans)
+                                            ->getOutput(),
+                                        false};
+                            auto last = rewriter.addOpWithOutputs<MatmulObj>(
+                                lhs.tensor, rhs.tensor, output, lhs.trans,
+                                rhs.trans,
+                                root->hasBias() ? root->getInputs(2) : nullptr);
+                            last->setClip(root->getClipMin(), root->getClipMax());
+                            return {output, false};
+                        };
+                        build(0, n - 1);
+                        for (auto &op : ops)
+                            rewriter.removeOperator(op);
+                        return true;
+                    }};
+        }
+
+        // The bounds of a Relu or a Clip, with infinite bounds missing
+        pair<optional<float>, optional<float>> clampBounds(const Operator &op)
+        {
+            if (op->getOpType() == OpType::Relu)
+                return {0.f, std::nullopt};
+            auto clip = as<ClipObj>(op);
+            optional<float> lo = clip->getMin(), hi = clip->getMax();
+            if (lo && std::isinf(*lo) && *lo < 0)
+                lo.reset();
+            if (hi && std::isinf(*hi) && *hi > 0)
+                hi.reset();
+            return {lo, hi};
+        }
+
+        // Clip(x, 0, +inf) -> Relu(x), and Clip(x) without bounds -> x
+        RewriteRule simplifyClip()
+        {
+            return {"SimplifyClip",
+                    {OpType::Clip},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto clip = match[0];
+                        auto [lo, hi] = clampBounds(clip);
+                        if (!lo && !hi)
+                            return bypass(rewriter, clip, clip->getInputs(0));
+                        if (lo != 0.f || hi)
+                            return false;
+                        rewriter.addOpWithOutputs<ReluObj>(clip->getInputs(0),
+                                                           clip->getOutput());
+                        rewriter.removeOperator(clip);
+                        return true;
+                    }};
+        }
+
+        /**
+         * @brief Relu(Relu(x)) -> Relu(x), and Clip(Clip(x)) -> Clip(x) with
+         * the bounds intersected, likewise for a Relu and a Clip, which
+         * clamp to [0, +inf).
+         */
+        RewriteRule composeClamps(OpType outerType, OpType innerType)
+        {
+            return {std::string("Compose") + outerType.toString() +
+                        innerType.toString(),
+                    {outerType, nullptr, {{0, {innerType}}}},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto outer = match[0], inner = match[1];
+                        auto [lo1, hi1] = clampBounds(inner);
+                        auto [lo2, hi2] = clampBounds(outer);
+                        auto [lo, hi] = composeClips(lo1, hi1, lo2, hi2);
+                        auto input = inner->getInputs(0);
+                        if (lo == 0.f && !hi && outer->getOpType() == OpType::Relu)
+                            rewriter.replaceInput(outer, 0, input);
+                        else
+                        {
+                            rewriter.addOpWithOutputs<ClipObj>(
+                                input, outer->getOutput(), lo, hi);
+                            rewriter.removeOperator(outer);
+                        }
+                        return true;
+                    }};
+        }
+
+        // Whether every value of 'from' is exactly a value of 'to'
+        bool isExactWidening(DataType from, DataType to)
+        {
+            auto isOneOf = [&](std::initializer_list<DataType> types)
+            {
+                return std::find(types.begin(), types.end(), from) !=
+                       types.end();
+            };
+            if (from == to)
+                return true;
+            if (to == DataType::Float32)
+                return isOneOf({DataType::Float16, DataType::BFloat16,
+                                DataType::Int8, DataType::UInt8,
+                                DataType::Int16, DataType::UInt16});
+            if (to == DataType::Double)
+                return isOneOf({DataType::Float32, DataType::Float16,
+                                DataType::BFloat16, DataType::Int8,
+                                DataType::UInt8, DataType::Int16,
+                                DataType::UInt16, DataType::Int32,
+                                DataType::UInt32});
+            if (to == DataType::Int16)
+                return isOneOf({DataType::Int8, DataType::UInt8});
+            if (to == DataType::Int32)
+                return isOneOf({DataType::Int8, DataType::UInt8,
+                                DataType::Int16, DataType::UInt16});
+            if (to == DataType::Int64)
+                return isOneOf({DataType::Int8, DataType::UInt8,
+                                DataType::Int16, DataType::UInt16,
+                                DataType::Int32, DataType::UInt32});
+            return false;
+        }
+
+        // Cast(x) -> x for a cast to the type of x, such as Float2Float
+        RewriteRule eliminateIdentityCast()
+        {
+            return {"EliminateIdentityCast",
+                    {OpType::Cast,
+                     [](const Operator &op)
+                     {
+                         return op->getInputs(0)->getDType() ==
+                                op->getOutput()->getDType();
+                     }},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        return bypass(rewriter, match[0],
+                                      match[0]->getInputs(0));
+                    }};
+        }
+
+        // Cast(Cast(x)) -> x when the inner cast widens x exactly and the
+        // outer one casts it back
+        RewriteRule eliminateCastRoundTrip()
+        {
+            return {"EliminateCastRoundTrip",
+                    {OpType::Cast, nullptr, {{0, {OpType::Cast}}}},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto outer = match[0], inner = match[1];
+                        auto input = inner->getInputs(0);
+                        if (outer->getOutput()->getDType() != input->getDType() ||
+                            !isExactWidening(input->getDType(),
+                                             inner->getOutput()->getDType()))
+                            return false;
+                        return bypass(rewriter, outer, input);
+                    }};
+        }
+
+        // Whether 'tensor' is a constant whose elements all equal 'value',
+        // with the same sign for a zero of a floating point dtype. Other
+        // dtypes than the arithmetic ones are not checked.
+        bool isFilledWith(const Tensor &tensor, double value)
+        {
+            if (!tensor->isConstant() ||
+                !hasDType(tensor->getDType(), ArithmeticDTypes()))
+                return false;
+            return dispatchDType(
+                tensor->getDType(), ArithmeticDTypes(),
+                [&](auto tag)
+                {
+                    using T = typename decltype(tag)::type;
+                    auto data = tensor->getRawDataPtr<T *>();
+                    return std::all_of(
+                        data, data + tensor->size(),
+                        [&](T val)
+                        {
+                            return double(val) == value &&
+                                   (std::numeric_limits<T>::is_integer ||
+                                    std::signbit(double(val)) ==
+                                        std::signbit(value));
+                        });
+                });
+        }
+
+        /**
+         * @brief Add(x, -0), Sub(x, +0), Mul(x, 1) and Div(x, 1) -> x, where
+         * 'input' is the index of the constant, which must not broadcast x.
+         * x + (+0) is not x for x = -0, so a float Add needs the zeros to be
+         * negative, and a float Sub needs them positive.
+         */
+        RewriteRule eliminateNeutralOperand(OpType type, size_t input)
+        {
+            double neutral = type == OpType::Add   ? -0.0
+                             : type == OpType::Sub ? 0.0
+                                                   : 1.0;
+            return {std::string("EliminateNeutral") + type.toString() +
+                        std::to_string(input),
+                    {type},
+                    [input, neutral](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto op = match[0];
+                        auto x = op->getInputs(1 - input);
+                        if (x->getDims() != op->getOutput()->getDims() ||
+                            !isFilledWith(op->getInputs(input), neutral))
+                            return false;
+                        return bypass(rewriter, op, x);
+                    }};
+        }
+
+        /**
+         * @brief Runs an operator whose inputs are all constants once, and
+         * makes the readers of its outputs read the results, which are new
+         * constants. Graph outputs are left to be computed by the graph.
+         */
+        RewriteRule foldConstants(OpType type)
+        {
+            return {std::string("FoldConstant") + type.toString(),
+                    {type,
+                     [](const Operator &op)
+                     {
+                         auto &inputs = op->getInputs();
+                         return !inputs.empty() &&
+                                std::all_of(inputs.begin(), inputs.end(),
+                                            [](auto &input)
+                                            { return input->isConstant(); });
+                     }},
+                    [](GraphRewriter &rewriter, const Match &match)
+                    {
+                        auto op = match[0];
+                        auto graph = rewriter.getGraph();
+                        auto runtime = graph->getRuntime();
+                        auto kernelAttrs = KernelAttrs{
+                            runtime->getDevice(), op->getOpType().underlying()};
+                        const auto &kernelRegistry = KernelRegistry::getInstance();
+                        if (!kernelRegistry.hasKernel(kernelAttrs))
+                            return false;
+                        for (auto &output : op->getOutputs())
+                            if (rewriter.isGraphOutput(output))
+                                return false;
+                        TensorVec results;
+                        for (auto &output : op->getOutputs())
+                        {
+                            auto result = graph->addTensor(output->getDims(),
+                                                           output->getDType());
+                            graph->setConstant(result);
+                            results.push_back(result);
+                        }
+                        // the kernel may not support the dtypes of 'op', which
+                        // is then left to fail when the graph runs
+                        try
+                        {
+                            kernelRegistry.getKernel(kernelAttrs)
+                                ->compute(op->clone(op->getInputs(), results),
+                                          runtime.get());
+                        }
+                        catch (const Exception &)
+                        {
+                            for (auto &result : results)
+                                graph->removeTensor(result);
+                            return false;
+                        }
+                        for (size_t i = 0; i < results.size(); ++i)
+                            rewriter.replaceAllUses(op->getOutput(i), results[i]);
+                        return true;
+                    }};
+        }
+    } // namespace
+
+    vector<RewriteRule> constantFoldingRules()
+    {
+        vector<RewriteRule> ans;
+        // every operator type, which all come after Unknown
+        for (OpType::underlying_t type = OpType::Add; type <= OpType::Transpose;
+             ++type)
+            ans.push_back(foldConstants(OpType(type)));
+        return ans;
+    }
+
+    vector<RewriteRule> transposeRules()
+    {
+        return {composeTransposes(), eliminateIdentityTranspose(),
+                foldTransposeIntoMatmul(0),
+                foldTransposeIntoMatmul(1)};
+    }
+
+    vector<RewriteRule> transposeSinkingRules()
+    {
+        vector<RewriteRule> ans;
+        for (auto type : {OpType::Relu, OpType::Clip, OpType::Cast})
+            ans.push_back(sinkTransposeThroughUnary(type));
+        for (auto type : {OpType::Add, OpType::Sub, OpType::Mul, OpType::Div})
+        {
+            ans.push_back(sinkTransposeThroughElementWise(type, 0));
+            ans.push_back(sinkTransposeThroughElementWise(type, 1));
+        }
+        return ans;
+    }
+
+    vector<RewriteRule> matmulEpilogueRules()
+    {
+        return {fuseMatmulBias(0), fuseMatmulBias(1),
+                fuseMatmulClip(OpType::Relu), fuseMatmulClip(OpType::Clip)};
+    }
+
+    vector<RewriteRule> horizontalFusionRules()
+    {
+        return {fuseSiblingMatmuls()};
+    }
+
+    vector<RewriteRule> matmulChainRules() { return {reorderMatmulChain()}; }
+
+    vector<RewriteRule> algebraicRules()
+    {
+        vector<RewriteRule> ans{simplifyClip(), eliminateIdentityCast(),
+                                eliminateCastRoundTrip()};
+        for (auto outer : {OpType::Relu, OpType::Clip})
+            for (auto inner : {OpType::Relu, OpType::Clip})
+                ans.push_back(composeClamps(outer, inner));
+        for (auto type : {OpType::Add, OpType::Mul})
+            ans.push_back(eliminateNeutralOperand(type, 0));
+        for (auto type : {OpType::Add, OpType::Sub, OpType::Mul, OpType::Div})
+            ans.push_back(eliminateNeutralOperand(type, 1));
+        return ans;
+    }
+
+    vector<RewriteRule> defaultRewriteRules()
+    {
+        vector<RewriteRule> ans;
+        for (auto rules : {constantFoldingRules(), algebraicRules(),
+                           transposeRules(),
+                           transposeSinkingRules(),
+                           matmulChainRules(), matmulEpilogueRules(),
+                           horizontalFusionRules()})
+        {
+            for (auto &rule : rules)
+                ans.push_back(std::move(rule));
+        }
+        return ans;
+    }
+
+} // namespace infini
@@ -3,11 +3,25 @@
 #include "core/kernel.h"
 #include "core/graph.h"
 #include "core/kernel.h"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 namespace infini
 {
+    int RuntimeObj::getNumThreads() const
+    {
+#ifdef _OPENMP
+        return numThreads > 0 ? numThreads : omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
     void NativeCpuRuntimeObj::run(const Graph &graph) const
     {
         const auto &kernelRegistry = KernelRegistry::getInstance();
@@ -29,8 +43,13 @@ namespace infini
 
     void *NativeCpuRuntimeObj::alloc(size_t size)
     {
-        return calloc((size + sizeof(uint64_t) - 1) / sizeof(uint64_t),
-                      sizeof(uint64_t));
+        // aligned_alloc requires the size to be a nonzero multiple of the
+        // alignment
+        size = std::max((size + alignment - 1) / alignment, size_t(1)) * alignment;
+        void *ptr = std::aligned_alloc(alignment, size);
+        IT_ASSERT(ptr != nullptr, "Failed to allocate " + std::to_string(size) +
+                                      " bytes");
+        return ptr;
     }
 
 } // namespace infini
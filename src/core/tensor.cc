@@ -46,28 +46,10 @@ void TensorObj::printData() const {
     if (!runtime->isCpu())
         IT_TODO_HALT();
 
-#define TRY_PRINT(N)                                                           \
-    if (dtype == DataType(N))                                                  \
-        std::cout << dataToString<DT<N>::t>() << std::endl;
-
-    TRY_PRINT(0)           // fmt: new line
-    else TRY_PRINT(1)      //
-        else TRY_PRINT(2)  //
-        else TRY_PRINT(3)  //
-        else TRY_PRINT(4)  //
-        else TRY_PRINT(5)  //
-        else TRY_PRINT(6)  //
-        else TRY_PRINT(7)  //
-        else TRY_PRINT(8)  //
-        else TRY_PRINT(9)  //
-        else TRY_PRINT(10) //
-        else TRY_PRINT(11) //
-        else TRY_PRINT(12) //
-        else TRY_PRINT(13) //
-        else TRY_PRINT(16) //
-        else IT_TODO_HALT();
-
-#undef TRY_PRINT
+    dispatchDType(dtype, AllDTypes(), [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        std::cout << dataToString<T>() << std::endl;
+    });
 }
 
 bool TensorObj::equalData(const Tensor &rhs, double relativeError) const {
@@ -79,30 +61,11 @@ bool TensorObj::equalData(const Tensor &rhs, double relativeError) const {
     if (size() != rhs->size())
         return false;
 
-#define TEST_EQUAL(N)                                                          \
-    if (dtype == DataType(N))                                                  \
-        return equalDataImpl(getRawDataPtr<DT<N>::t *>(),                      \
-                             rhs->getRawDataPtr<DT<N>::t *>(), size(),         \
-                             relativeError);
-
-    TEST_EQUAL(0)           // fmt: new line
-    else TEST_EQUAL(1)      //
-        else TEST_EQUAL(2)  //
-        else TEST_EQUAL(3)  //
-        else TEST_EQUAL(4)  //
-        else TEST_EQUAL(5)  //
-        else TEST_EQUAL(6)  //
-        else TEST_EQUAL(7)  //
-        else TEST_EQUAL(8)  //
-        else TEST_EQUAL(9)  //
-        else TEST_EQUAL(10) //
-        else TEST_EQUAL(11) //
-        else TEST_EQUAL(12) //
-        else TEST_EQUAL(13) //
-        else TEST_EQUAL(16) //
-        else IT_TODO_HALT();
-
-#undef TEST_EQUAL
+    return dispatchDType(dtype, AllDTypes(), [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        return equalDataImpl(getRawDataPtr<T *>(), rhs->getRawDataPtr<T *>(),
+                             size(), relativeError);
+    });
 }
 
 void TensorObj::setData(
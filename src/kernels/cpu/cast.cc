@@ -0,0 +1,311 @@
+#include "core/kernel.h"
+#include "operators/unary.h"
+#include "utils/half.h"
+#include "utils/parallel.h"
+#include "utils/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace infini {
+
+namespace {
+
+// Converts n elements from src to dst.
+using CastFn = void (*)(const void *src, void *dst, size_t n);
+
+template <typename Src, typename Dst> struct StaticCast {
+    Dst operator()(Src x) const { return static_cast<Dst>(x); }
+};
+
+// Float to integers truncates like static_cast and saturates at the bounds
+// of Dst, with NaN as 0, like the vector conversions do. The bounds are
+// applied in float, as static_cast is undefined out of the range of Dst.
+template <typename Dst> struct FloatToIntSat {
+    Dst operator()(float x) const {
+        // -min is a power of two, so it is exact in float, unlike max
+        constexpr float limit = -float(std::numeric_limits<Dst>::min());
+        if (std::isnan(x))
+            return 0;
+        if (x >= limit)
+            return std::numeric_limits<Dst>::max();
+        return static_cast<Dst>(std::max(x, -limit));
+    }
+};
+
+using FloatToInt32 = FloatToIntSat<int32_t>;
+using Int32ToFloat = StaticCast<int32_t, float>;
+using Int8ToFloat = StaticCast<int8_t, float>;
+using Int64ToInt32 = StaticCast<int64_t, int32_t>;
+using Int32ToInt64 = StaticCast<int32_t, int64_t>;
+using FloatToInt8 = FloatToIntSat<int8_t>;
+
+template <typename Src, typename Dst, typename Op = StaticCast<Src, Dst>>
+void castScalar(const void *src, void *dst, size_t n) {
+    auto s = static_cast<const Src *>(src);
+    auto d = static_cast<Dst *>(dst);
+    Op op;
+    for (size_t i = 0; i < n; ++i)
+        d[i] = op(s[i]);
+}
+
+#if IT_X86
+// GCC 12 warns about the _mm512_undefined_* placeholders inside the AVX-512
+// conversion intrinsics.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+// Every vector loop converts the tail with the scalar loop of the same cast.
+#define CAST_VECTOR_LOOP(Src, Dst, Op, WIDTH, BODY)                            \
+    auto s = static_cast<const Src *>(src);                                    \
+    auto d = static_cast<Dst *>(dst);                                          \
+    size_t i = 0;                                                              \
+    for (; i + WIDTH <= n; i += WIDTH) {                                       \
+        BODY;                                                                  \
+    }                                                                          \
+    castScalar<Src, Dst, Op>(s + i, d + i, n - i);
+
+// cvttps gives INT_MIN out of the int32 range and for NaN. NaNs are zeroed
+// first, and the lanes at or above 2^31 are set to INT_MAX after, like
+// FloatToIntSat. Narrower integers are clamped to [lo, hi] in float instead.
+IT_TARGET_AVX2 inline __m256 zeroNanAvx2(__m256 x) {
+    return _mm256_and_ps(x, _mm256_cmp_ps(x, x, _CMP_ORD_Q));
+}
+
+IT_TARGET_AVX512 inline __m512 zeroNanAvx512(__m512 x) {
+    return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, x, _CMP_ORD_Q), x);
+}
+
+IT_TARGET_AVX2 inline __m256i cvtSatAvx2(__m256 x) {
+    x = zeroNanAvx2(x);
+    // all ones, which turn INT_MIN into INT_MAX
+    __m256i big = _mm256_castps_si256(
+        _mm256_cmp_ps(x, _mm256_set1_ps(2147483648.f), _CMP_GE_OQ));
+    return _mm256_xor_si256(_mm256_cvttps_epi32(x), big);
+}
+
+IT_TARGET_AVX512 inline __m512i cvtSatAvx512(__m512 x) {
+    x = zeroNanAvx512(x);
+    __mmask16 big =
+        _mm512_cmp_ps_mask(x, _mm512_set1_ps(2147483648.f), _CMP_GE_OQ);
+    return _mm512_mask_mov_epi32(_mm512_cvttps_epi32(x), big,
+                                 _mm512_set1_epi32(INT32_MAX));
+}
+
+IT_TARGET_AVX2 inline __m256 clampAvx2(__m256 x, float lo, float hi) {
+    return _mm256_min_ps(_mm256_max_ps(zeroNanAvx2(x), _mm256_set1_ps(lo)),
+                         _mm256_set1_ps(hi));
+}
+
+IT_TARGET_AVX512 inline __m512 clampAvx512(__m512 x, float lo, float hi) {
+    return _mm512_min_ps(_mm512_max_ps(zeroNanAvx512(x), _mm512_set1_ps(lo)),
+                         _mm512_set1_ps(hi));
+}
+
+IT_TARGET_AVX2 void floatToInt32Avx2(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(float, int32_t, FloatToInt32, 8,
+                     _mm256_storeu_si256((__m256i *)(d + i),
+                                         cvtSatAvx2(_mm256_loadu_ps(s + i))))
+}
+
+IT_TARGET_AVX512 void floatToInt32Avx512(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(float, int32_t, FloatToInt32, 16,
+                     _mm512_storeu_si512(d + i,
+                                         cvtSatAvx512(_mm512_loadu_ps(s + i))))
+}
+
+IT_TARGET_AVX2 void int32ToFloatAvx2(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(int32_t, float, Int32ToFloat, 8,
+                     _mm256_storeu_ps(d + i,
+                                      _mm256_cvtepi32_ps(_mm256_loadu_si256(
+                                          (const __m256i *)(s + i)))))
+}
+
+IT_TARGET_AVX512 void int32ToFloatAvx512(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(int32_t, float, Int32ToFloat, 16,
+                     _mm512_storeu_ps(d + i, _mm512_cvtepi32_ps(
+                                                 _mm512_loadu_si512(s + i))))
+}
+
+IT_TARGET_AVX2 void floatToInt8Avx2(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(
+        float, int8_t, FloatToInt8, 8,
+        __m256i x = _mm256_cvttps_epi32(
+            clampAvx2(_mm256_loadu_ps(s + i), -128.f, 127.f));
+        __m128i x16 = _mm_packs_epi32(_mm256_castsi256_si128(x),
+                                      _mm256_extracti128_si256(x, 1));
+        _mm_storel_epi64((__m128i *)(d + i), _mm_packs_epi16(x16, x16)))
+}
+
+IT_TARGET_AVX512 void floatToInt8Avx512(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(float, int8_t, FloatToInt8, 16,
+                     _mm_storeu_si128((__m128i *)(d + i),
+                                      _mm512_cvtsepi32_epi8(_mm512_cvttps_epi32(
+                                          clampAvx512(_mm512_loadu_ps(s + i),
+                                                      -128.f, 127.f)))))
+}
+
+IT_TARGET_AVX2 void int8ToFloatAvx2(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(int8_t, float, Int8ToFloat, 8,
+                     _mm256_storeu_ps(d + i,
+                                      _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(
+                                          _mm_loadl_epi64(
+                                              (const __m128i *)(s + i))))))
+}
+
+IT_TARGET_AVX512 void int8ToFloatAvx512(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(int8_t, float, Int8ToFloat, 16,
+                     _mm512_storeu_ps(d + i,
+                                      _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(
+                                          _mm_loadu_si128(
+                                              (const __m128i *)(s + i))))))
+}
+
+IT_TARGET_AVX2 void int64ToInt32Avx2(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(
+        int64_t, int32_t, Int64ToInt32, 4,
+        __m256i x = _mm256_loadu_si256((const __m256i *)(s + i));
+        // keep the low half of every element
+        __m256i lo = _mm256_permutevar8x32_epi32(
+            x, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+        _mm_storeu_si128((__m128i *)(d + i), _mm256_castsi256_si128(lo)))
+}
+
+IT_TARGET_AVX512 void int64ToInt32Avx512(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(int64_t, int32_t, Int64ToInt32, 8,
+                     _mm256_storeu_si256(
+                         (__m256i *)(d + i),
+                         _mm512_cvtepi64_epi32(_mm512_loadu_si512(s + i))))
+}
+
+IT_TARGET_AVX2 void int32ToInt64Avx2(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(int32_t, int64_t, Int32ToInt64, 4,
+                     _mm256_storeu_si256(
+                         (__m256i *)(d + i),
+                         _mm256_cvtepi32_epi64(
+                             _mm_loadu_si128((const __m128i *)(s + i)))))
+}
+
+IT_TARGET_AVX512 void int32ToInt64Avx512(const void *src, void *dst, size_t n) {
+    CAST_VECTOR_LOOP(int32_t, int64_t, Int32ToInt64, 8,
+                     _mm512_storeu_si512(
+                         d + i, _mm512_cvtepi32_epi64(_mm256_loadu_si256(
+                                    (const __m256i *)(s + i)))))
+}
+
+#undef CAST_VECTOR_LOOP
+#pragma GCC diagnostic pop
+#endif
+
+// The conversions of fp16 and bf16 are shared with the other kernels
+template <typename Src, typename Dst>
+void convertHalf(const void *src, void *dst, size_t n) {
+    if constexpr (std::is_same_v<Src, float>)
+        convertFromFloat(static_cast<const float *>(src),
+                         static_cast<Dst *>(dst), n);
+    else
+        convertToFloat(static_cast<const Src *>(src), static_cast<float *>(dst),
+                       n);
+}
+
+void copyFloat(const void *src, void *dst, size_t n) {
+    std::copy_n(static_cast<const float *>(src), n, static_cast<float *>(dst));
+}
+
+// Picks the vector version of a cast when the CPU supports it.
+#if IT_X86
+#define SELECT(SCALAR, AVX2, AVX512)                                           \
+    (cpuIsa() == CpuIsa::Avx512 ? AVX512                                       \
+     : cpuIsa() == CpuIsa::Avx2 ? AVX2                                         \
+                                : SCALAR)
+#else
+#define SELECT(SCALAR, AVX2, AVX512) (SCALAR)
+#endif
+
+CastFn getCastFn(CastType type) {
+    switch (type) {
+    case CastType::Float2Float16:
+        return convertHalf<float, float16_t>;
+    case CastType::Float2Int64:
+        return castScalar<float, int64_t, FloatToIntSat<int64_t>>;
+    case CastType::Float2Int32:
+        return SELECT((castScalar<float, int32_t, FloatToInt32>),
+                      floatToInt32Avx2,
+                      floatToInt32Avx512);
+    case CastType::Float2Int16:
+        return castScalar<float, int16_t, FloatToIntSat<int16_t>>;
+    case CastType::Float2Int8:
+        return SELECT((castScalar<float, int8_t, FloatToInt8>),
+                      floatToInt8Avx2, floatToInt8Avx512);
+    case CastType::Float2BFloat16:
+        return convertHalf<float, bfloat16_t>;
+    case CastType::Int322Float:
+        return SELECT((castScalar<int32_t, float>), int32ToFloatAvx2,
+                      int32ToFloatAvx512);
+    case CastType::Int322Int8:
+        return castScalar<int32_t, int8_t>;
+    case CastType::Int322Int16:
+        return castScalar<int32_t, int16_t>;
+    case CastType::Int322Int64:
+        return SELECT((castScalar<int32_t, int64_t>), int32ToInt64Avx2,
+                      int32ToInt64Avx512);
+    case CastType::Int162Float:
+        return castScalar<int16_t, float>;
+    case CastType::Int162Int32:
+        return castScalar<int16_t, int32_t>;
+    case CastType::Int82Float:
+        return SELECT((castScalar<int8_t, float>), int8ToFloatAvx2,
+                      int8ToFloatAvx512);
+    case CastType::Int82Int16:
+        return castScalar<int8_t, int16_t>;
+    case CastType::Int82Int32:
+        return castScalar<int8_t, int32_t>;
+    case CastType::Uint82Float:
+        return castScalar<uint8_t, float>;
+    case CastType::Uint82Int32:
+        return castScalar<uint8_t, int32_t>;
+    case CastType::Uint82Int64:
+        return castScalar<uint8_t, int64_t>;
+    case CastType::Int642Int32:
+        return SELECT((castScalar<int64_t, int32_t>), int64ToInt32Avx2,
+                      int64ToInt32Avx512);
+    case CastType::Int642Uint32:
+        return castScalar<int64_t, uint32_t>;
+    case CastType::Int642Float:
+        return castScalar<int64_t, float>;
+    case CastType::Uint322Int64:
+        return castScalar<uint32_t, int64_t>;
+    case CastType::Float162Float:
+        return convertHalf<float16_t, float>;
+    case CastType::BFloat162Float:
+        return convertHalf<bfloat16_t, float>;
+    case CastType::Float2Float:
+        return copyFloat;
+    default:
+        IT_TODO_HALT();
+    }
+}
+
+#undef SELECT
+
+} // namespace
+
+class NativeCast : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<CastObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        auto cast = getCastFn(op->getType());
+        auto src = input->getRawDataPtr<char *>();
+        auto dst = output->getRawDataPtr<char *>();
+        size_t srcSize = input->getDType().getSize();
+        size_t dstSize = output->getDType().getSize();
+        size_t n = output->size();
+        parallelFor(context, n, PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            cast(src + begin * srcSize, dst + begin * dstSize, end - begin);
+        });
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Cast, NativeCast, "Cast_CPU");
+
+} // namespace infini
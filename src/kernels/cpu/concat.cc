@@ -1,64 +1,78 @@
 #include "operators/concat.h"
 #include "core/kernel.h"
+#include "utils/parallel.h"
+#include <cstring>
 
 namespace infini {
 
-class NaiveConcat : public CpuKernelWithoutConfig {
-    template <typename T>
-    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+/**
+ * @brief Concat as block copies. For every index of the dims before the
+ * axis, each input contributes one contiguous block, and the blocks of all
+ * inputs are laid out back to back in the output. Only the element size
+ * matters, so every dtype is supported.
+ */
+class NativeConcat : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
         auto op = as<ConcatObj>(_op);
-        auto inputs = op->getInputs(), outputs = op->getOutputs();
-        auto dim = op->getDim();
-        auto output = outputs[0];
-        std::vector<Shape> iDims;
-        for (auto input : inputs)
-            iDims.emplace_back(input->getDims());
+        auto inputs = op->getInputs();
+        auto output = op->getOutput();
+        size_t dim = op->getDim();
         const auto &outDim = output->getDims();
-        size_t blockOffsetInner = 1;
-        for (size_t i = outDim.size() - 1; i > (size_t)dim; --i)
-            blockOffsetInner *= outDim[i];
-        size_t blockOffset = outDim[dim] * blockOffsetInner;
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            auto input = inputs[i];
-            auto dimOffset = 0;
-            auto iDim = iDims[i];
-            for (size_t j = 0; j < i; ++j)
-                dimOffset += iDims[j][dim];
-            size_t localBlockOffset = 1;
-            for (size_t i = iDim.size() - 1;
-                 i >= (size_t)dim && i != (size_t)-1; --i)
-                localBlockOffset *= iDim[i];
-            auto innerOffset = blockOffsetInner * dimOffset;
-            auto inSize = input->size();
-            auto inPtr = input->getRawDataPtr<T *>(),
-                 outPtr = output->getRawDataPtr<T *>();
-#pragma omp parallel for
-            for (size_t iOffset = 0; iOffset < inSize; ++iOffset) {
-                auto oOffset = iOffset % localBlockOffset + innerOffset +
-                               iOffset / localBlockOffset * blockOffset;
-                outPtr[oOffset] = inPtr[iOffset];
-            }
-        }
-    }
+        size_t elemSize = output->getDType().getSize();
 
-    void compute(const Operator &_op,
-                 const RuntimeObj *context) const override {
-#define CASE(N)                                                                \
-    case N:                                                                    \
-        doCompute<DT<N>::t>(_op, context)
+        size_t outer = 1;
+        for (size_t i = 0; i < dim; ++i)
+            outer *= outDim[i];
+        // bytes of every block and their offsets in an output block
+        size_t n = inputs.size();
+        vector<size_t> blockBytes(n), blockOffsets(n);
+        size_t outBlockBytes = 0;
+        for (size_t i = 0; i < n; ++i) {
+            blockBytes[i] = inputs[i]->size() / outer * elemSize;
+            blockOffsets[i] = outBlockBytes;
+            outBlockBytes += blockBytes[i];
+        }
+        if (outer == 0 || outBlockBytes == 0)
+            return;
 
-        int dataTypeIdx = _op->getDType().getIndex();
-        switch (dataTypeIdx) {
-            CASE(1); // DataType::Float32
-            break;
-            CASE(12); // DataType::UInt32
-            break;
-        default:
-            IT_TODO_HALT();
+        auto outPtr = output->getRawDataPtr<char *>();
+        if (outer == 1) {
+            // one large block per input: split each copy instead
+            for (size_t i = 0; i < n; ++i) {
+                auto inPtr = inputs[i]->getRawDataPtr<char *>();
+                char *dst = outPtr + blockOffsets[i];
+                // the memory planner may have placed the input in its slice
+                // of the output already
+                if (inPtr == dst)
+                    continue;
+                parallelFor(context, blockBytes[i], PARALLEL_GRAIN * elemSize,
+                            [&](size_t begin, size_t end) {
+                                std::memcpy(dst + begin, inPtr + begin,
+                                            end - begin);
+                            });
+            }
+            return;
         }
+
+        vector<const char *> inPtrs(n);
+        for (size_t i = 0; i < n; ++i)
+            inPtrs[i] = inputs[i]->getRawDataPtr<char *>();
+        size_t avgBlockBytes = std::max(outBlockBytes / n, size_t(1));
+        parallelFor(context, outer * n,
+                    PARALLEL_GRAIN * elemSize / avgBlockBytes + 1,
+                    [&](size_t begin, size_t end) {
+                        for (size_t task = begin; task < end; ++task) {
+                            size_t o = task / n, i = task % n;
+                            std::memcpy(outPtr + o * outBlockBytes +
+                                            blockOffsets[i],
+                                        inPtrs[i] + o * blockBytes[i],
+                                        blockBytes[i]);
+                        }
+                    });
     }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Concat, NaiveConcat, "ConcatNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Concat, NativeConcat, "Concat_CPU");
 
 } // namespace infini
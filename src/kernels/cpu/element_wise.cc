@@ -1,33 +1,130 @@
 #include "operators/element_wise.h"
 #include "core/kernel.h"
 #include "utils/operator_utils.h"
+#include "utils/parallel.h"
+#include "utils/simd.h"
 
 namespace infini
 {
     class NativeElementWise : public CpuKernelWithoutConfig
     {
-        template <typename T>
-        static T addCompute(T val0, T val1)
-        {
-            return val0 + val1;
-        }
-
-        template <typename T>
-        static T subCompute(T val0, T val1)
-        {
-            return val0 - val1;
-        }
+        // The ops are functors so that the loops can inline them, with an
+        // overload for each vector type of utils/simd.h.
+#if IT_X86
+#define VECTOR_OP(name)                                                     \
+    IT_TARGET_AVX2 __m256 operator()(__m256 val0, __m256 val1) const        \
+    {                                                                       \
+        return _mm256_##name##_ps(val0, val1);                              \
+    }                                                                       \
+    IT_TARGET_AVX512 __m512 operator()(__m512 val0, __m512 val1) const      \
+    {                                                                       \
+        return _mm512_##name##_ps(val0, val1);                              \
+    }
+#else
+#define VECTOR_OP(name)
+#endif
+#define BINARY_OP(Name, name, expr)                                         \
+    struct Name                                                             \
+    {                                                                       \
+        template <typename T>                                               \
+        T operator()(T val0, T val1) const                                  \
+        {                                                                   \
+            return expr;                                                    \
+        }                                                                   \
+        VECTOR_OP(name)                                                     \
+    };
 
-        template <typename T>
-        static T mulCompute(T val0, T val1)
-        {
-            return val0 * val1;
-        }
+        BINARY_OP(AddOp, add, val0 + val1)
+        BINARY_OP(SubOp, sub, val0 - val1)
+        BINARY_OP(MulOp, mul, val0 * val1)
+        BINARY_OP(DivOp, div, (T)(val0 / val1))
+#undef BINARY_OP
+#undef VECTOR_OP
 
-        template <typename T>
-        static T divCompute(T val0, T val1)
+        // Runs op over the broadcast described by info, as contiguous spans
+        // in which each input either advances with c or repeats one element.
+        // The spans are split across the threads of the runtime.
+        template <typename T, typename Op>
+        static void broadcastCompute(const RuntimeObj *context,
+                                     const BroadcastInfo &info, const T *a,
+                                     const T *b, T *c, size_t n, Op op)
         {
-            return (T)(val0 / val1);
+            // an empty output would make the spans below empty too
+            if (n == 0)
+                return;
+            switch (info.kind)
+            {
+            case BroadcastInfo::Same:
+            case BroadcastInfo::ScalarA:
+            case BroadcastInfo::ScalarB:
+            {
+                size_t strideA = info.kind != BroadcastInfo::ScalarA;
+                size_t strideB = info.kind != BroadcastInfo::ScalarB;
+                parallelFor(context, n, PARALLEL_GRAIN,
+                            [&](size_t begin, size_t end)
+                            {
+                                vectorizedBinary(a + begin * strideA, strideA,
+                                                 b + begin * strideB, strideB,
+                                                 c + begin, end - begin, op);
+                            });
+                break;
+            }
+            case BroadcastInfo::RowA:
+            case BroadcastInfo::RowB:
+            case BroadcastInfo::ColumnA:
+            case BroadcastInfo::ColumnB:
+            {
+                size_t rows = info.dims[0], cols = info.dims[1];
+                parallelFor(context, rows, PARALLEL_GRAIN / cols,
+                            [&](size_t begin, size_t end)
+                            {
+                                for (size_t r = begin; r < end; ++r)
+                                    vectorizedBinary(
+                                        a + r * info.strideA[0], info.strideA[1],
+                                        b + r * info.strideB[0], info.strideB[1],
+                                        c + r * cols, cols, op);
+                            });
+                break;
+            }
+            case BroadcastInfo::General:
+            {
+                // walk the outer dims like an odometer, moving the input
+                // offsets by their strides instead of decoding every index
+                size_t rank = info.dims.size();
+                size_t inner = info.dims[rank - 1];
+                parallelFor(
+                    context, n / inner, PARALLEL_GRAIN / inner,
+                    [&](size_t begin, size_t end)
+                    {
+                        vector<size_t> index(rank - 1);
+                        size_t offsetA = 0, offsetB = 0;
+                        for (size_t d = rank - 1, rest = begin; d-- > 0;)
+                        {
+                            index[d] = rest % info.dims[d];
+                            rest /= info.dims[d];
+                            offsetA += index[d] * info.strideA[d];
+                            offsetB += index[d] * info.strideB[d];
+                        }
+                        for (size_t span = begin; span < end; ++span)
+                        {
+                            vectorizedBinary(a + offsetA, info.strideA[rank - 1],
+                                             b + offsetB, info.strideB[rank - 1],
+                                             c + span * inner, inner, op);
+                            for (size_t d = rank - 1; d-- > 0;)
+                            {
+                                offsetA += info.strideA[d];
+                                offsetB += info.strideB[d];
+                                if (++index[d] < size_t(info.dims[d]))
+                                    break;
+                                offsetA -= info.strideA[d] * info.dims[d];
+                                offsetB -= info.strideB[d] * info.dims[d];
+                                index[d] = 0;
+                            }
+                        }
+                    });
+                break;
+            }
+            }
         }
 
         template <typename T>
@@ -38,78 +135,41 @@ namespace infini
             T *inptr1 = op->getInputs(1)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
 
-            auto shapeA = op->getInputs(0)->getDims();
-            auto shapeB = op->getInputs(1)->getDims();
-            auto shapeC = op->getOutput()->getDims();
-            auto rank = op->getOutput()->getRank();
-            Shape a(rank, 1);
-            Shape b(rank, 1);
-            std::copy(shapeA.begin(), shapeA.end(),
-                      a.begin() + (rank - shapeA.size()));
-            std::copy(shapeB.begin(), shapeB.end(),
-                      b.begin() + (rank - shapeB.size()));
-            auto getStride = [&](const Shape &shape)
-            {
-                int p = 1;
-                Shape stride(rank);
-                for (auto i = rank; i > 0; --i)
-                {
-                    stride[i - 1] = p;
-                    p = p * shape[i - 1];
-                }
-                return stride;
-            };
-            Shape strideA = getStride(a);
-            Shape strideB = getStride(b);
-
+            auto info = analyze_broadcast(op->getInputs(0)->getDims(),
+                                          op->getInputs(1)->getDims(),
+                                          op->getOutput()->getDims());
             auto n = op->getOutput()->size();
-            T (*_doCompute)
-            (T val0, T val1);
             switch (op->getOpType().underlying())
             {
             case OpType::Add:
-                _doCompute = addCompute<T>;
+                broadcastCompute(context, info, inptr0, inptr1, outptr, n, AddOp());
                 break;
             case OpType::Sub:
-                _doCompute = subCompute<T>;
+                broadcastCompute(context, info, inptr0, inptr1, outptr, n, SubOp());
                 break;
             case OpType::Mul:
-                _doCompute = mulCompute<T>;
+                broadcastCompute(context, info, inptr0, inptr1, outptr, n, MulOp());
                 break;
             case OpType::Div:
-                _doCompute = divCompute<T>;
+                broadcastCompute(context, info, inptr0, inptr1, outptr, n, DivOp());
                 break;
             default:
                 IT_TODO_HALT();
             }
-
-            for (size_t i = 0; i < n; ++i)
-            {
-                auto shapeIndexC = locate_index(i, shapeC);
-                auto indexA = delocate_index(shapeIndexC, a, strideA);
-                auto indexB = delocate_index(shapeIndexC, b, strideB);
-                outptr[i] = _doCompute(inptr0[indexA], inptr1[indexB]);
-            }
         }
 
         void compute(const Operator &_op,
                      const RuntimeObj *context) const override
         {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
-            {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
-            }
+            dispatchDType(_op->getDType(), ArithmeticDTypes(),
+                          [&](auto tag)
+                          {
+                              using T = typename decltype(tag)::type;
+                              doCompute<T>(_op, context);
+                          });
         }
+
+        bool supportInplace() const override { return true; }
     };
 
     REGISTER_KERNEL(Device::CPU, OpType::Add, NativeElementWise, "addNaive_CPU");
@@ -0,0 +1,600 @@
+#include "operators/matmul.h"
+#include "core/kernel.h"
+#include "utils/operator_utils.h"
+#include "utils/simd.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+
+namespace infini {
+
+namespace {
+
+// Cache blocking of the GEMM: an MC x KC block of A and a KC x NC panel of B
+// are packed so that they stay in L2 while the micro-kernel walks them, and
+// each MR x NR tile of C is kept in registers over KC steps. MC and NC must
+// be multiples of every MR and NR below.
+constexpr size_t MC = 96, NC = 512, KC = 256;
+
+/**
+ * @brief A matrix with arbitrary row and column strides, so that transposed
+ * operands are read in place instead of being materialized. One of the
+ * strides is 1.
+ */
+template <typename T> struct MatrixView {
+    const T *data;
+    size_t rowStride, colStride;
+
+    const T *ptr(size_t i, size_t j) const {
+        return data + i * rowStride + j * colStride;
+    }
+};
+
+/**
+ * @brief Copies n contiguous elements to the type the micro-kernel computes
+ * in, which widens fp16 and bf16 to fp32.
+ */
+template <typename T, typename Acc>
+void loadSpan(const T *src, Acc *dst, size_t n) {
+    if constexpr (std::is_same_v<T, Acc>)
+        std::copy_n(src, n, dst);
+    else
+        convertToFloat(src, dst, n);
+}
+
+/**
+ * @brief Scatters n contiguous elements to dst[0], dst[stride], ..., widened
+ * to Acc through 'buffer' when their type differs.
+ */
+template <typename T, typename Acc>
+void scatterSpan(const T *src, Acc *dst, size_t stride, size_t n,
+                 Acc *buffer) {
+    const Acc *span;
+    if constexpr (std::is_same_v<T, Acc>) {
+        span = src;
+    } else {
+        convertToFloat(src, buffer, n);
+        span = buffer;
+    }
+    for (size_t i = 0; i < n; ++i)
+        dst[i * stride] = span[i];
+}
+
+/**
+ * @brief Packs rows [i0, i0 + mc) and columns [p0, p0 + kc) of A into panels
+ * of MR rows. Inside a panel the MR elements of a column are contiguous. Rows
+ * beyond m are padded with zeros.
+ */
+template <size_t MR, typename T, typename Acc>
+void packA(const MatrixView<T> &a, size_t m, size_t i0, size_t mc, size_t p0,
+           size_t kc, Acc *dst) {
+    Acc buffer[KC];
+    for (size_t ir = 0; ir < mc; ir += MR, dst += MR * kc) {
+        size_t rows = std::min(MR, m - (i0 + ir));
+        if (a.colStride == 1) {
+            for (size_t i = 0; i < rows; ++i)
+                scatterSpan(a.ptr(i0 + ir + i, p0), dst + i, MR, kc, buffer);
+        } else {
+            // columns are contiguous, like in the panel
+            for (size_t p = 0; p < kc; ++p)
+                loadSpan(a.ptr(i0 + ir, p0 + p), dst + p * MR, rows);
+        }
+        for (size_t i = rows; i < MR; ++i) {
+            for (size_t p = 0; p < kc; ++p)
+                dst[p * MR + i] = Acc(0);
+        }
+    }
+}
+
+/**
+ * @brief Packs rows [p0, p0 + kc) and columns [j0, j0 + nc) of B into panels
+ * of NR columns. Inside a panel the NR elements of a row are contiguous.
+ * Columns beyond n are padded with zeros.
+ */
+template <size_t NR, typename T, typename Acc>
+void packB(const MatrixView<T> &b, size_t n, size_t p0, size_t kc, size_t j0,
+           size_t nc, Acc *dst) {
+    Acc buffer[KC];
+    for (size_t jr = 0; jr < nc; jr += NR, dst += NR * kc) {
+        size_t cols = std::min(NR, n - (j0 + jr));
+        if (b.colStride == 1) {
+            // rows are contiguous, like in the panel
+            for (size_t p = 0; p < kc; ++p)
+                loadSpan(b.ptr(p0 + p, j0 + jr), dst + p * NR, cols);
+        } else {
+            for (size_t j = 0; j < cols; ++j)
+                scatterSpan(b.ptr(p0, j0 + jr + j), dst + j, NR, kc, buffer);
+        }
+        for (size_t p = 0; p < kc; ++p) {
+            for (size_t j = cols; j < NR; ++j)
+                dst[p * NR + j] = Acc(0);
+        }
+    }
+}
+
+/**
+ * @brief The fused epilogue of a tile of C, applied after its last block of
+ * k: C += bias, then C is clamped to [lo, hi] if 'clip'. 'bias' points to
+ * the bias of the first element of the tile, or is null; its column stride
+ * is 0 when it is broadcast along the rows of C and 1 otherwise.
+ */
+template <typename Acc> struct Epilogue {
+    const Acc *bias;
+    size_t biasRowStride, biasColStride;
+    Acc lo{}, hi{};
+    bool clip;
+
+    // Clamps like the Clip kernel: NaNs pass through
+    Acc operator()(Acc val, size_t i, size_t j) const {
+        if (bias)
+            val += bias[i * biasRowStride + j * biasColStride];
+        if (clip) {
+            val = lo > val ? lo : val;
+            val = hi < val ? hi : val;
+        }
+        return val;
+    }
+};
+
+/**
+ * @brief Portable micro-kernel. C[MR x NR] (+)= A panel * B panel, followed
+ * by the epilogue if there is one.
+ */
+template <typename T> struct GenericMicroKernel {
+    using Acc = T;
+    static constexpr size_t MR = 4, NR = 16;
+
+    static void run(size_t kc, const T *a, const T *b, T *c, size_t ldc,
+                    bool accumulate, const Epilogue<T> *epilogue) {
+        T acc[MR][NR] = {};
+        for (size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+            for (size_t i = 0; i < MR; ++i) {
+                for (size_t j = 0; j < NR; ++j)
+                    acc[i][j] += a[i] * b[j];
+            }
+        }
+        for (size_t i = 0; i < MR; ++i) {
+            for (size_t j = 0; j < NR; ++j) {
+                T val = accumulate ? c[i * ldc + j] + acc[i][j] : acc[i][j];
+                c[i * ldc + j] = epilogue ? (*epilogue)(val, i, j) : val;
+            }
+        }
+    }
+};
+
+#if IT_X86
+// GCC 12 warns about the _mm512_undefined_* placeholders inside the AVX-512
+// broadcasts of the epilogue.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+// The epilogue of the 8 or 16 elements of row i of a tile from column j
+IT_TARGET_AVX2 inline __m256 applyEpilogue(const Epilogue<float> &e, __m256 v,
+                                           size_t i, size_t j) {
+    if (e.bias) {
+        const float *bias = e.bias + i * e.biasRowStride;
+        v = _mm256_add_ps(v, e.biasColStride ? _mm256_loadu_ps(bias + j)
+                                             : _mm256_set1_ps(*bias));
+    }
+    if (e.clip)
+        v = _mm256_min_ps(_mm256_set1_ps(e.hi),
+                          _mm256_max_ps(_mm256_set1_ps(e.lo), v));
+    return v;
+}
+
+IT_TARGET_AVX512 inline __m512 applyEpilogue(const Epilogue<float> &e,
+                                             __m512 v, size_t i, size_t j) {
+    if (e.bias) {
+        const float *bias = e.bias + i * e.biasRowStride;
+        v = _mm512_add_ps(v, e.biasColStride ? _mm512_loadu_ps(bias + j)
+                                             : _mm512_set1_ps(*bias));
+    }
+    if (e.clip)
+        v = _mm512_min_ps(_mm512_set1_ps(e.hi),
+                          _mm512_max_ps(_mm512_set1_ps(e.lo), v));
+    return v;
+}
+
+struct Avx2MicroKernel {
+    using Acc = float;
+    static constexpr size_t MR = 6, NR = 16;
+
+    IT_TARGET_AVX2 static void run(size_t kc, const float *a, const float *b,
+                                   float *c, size_t ldc, bool accumulate,
+                                   const Epilogue<float> *epilogue) {
+        __m256 acc[MR][2];
+#pragma GCC unroll 6
+        for (size_t i = 0; i < MR; ++i)
+            acc[i][0] = acc[i][1] = _mm256_setzero_ps();
+        for (size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+            __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+#pragma GCC unroll 6
+            for (size_t i = 0; i < MR; ++i) {
+                __m256 ai = _mm256_broadcast_ss(a + i);
+                acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+                acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+            }
+        }
+#pragma GCC unroll 6
+        for (size_t i = 0; i < MR; ++i) {
+            float *ci = c + i * ldc;
+            if (accumulate) {
+                acc[i][0] = _mm256_add_ps(acc[i][0], _mm256_loadu_ps(ci));
+                acc[i][1] = _mm256_add_ps(acc[i][1], _mm256_loadu_ps(ci + 8));
+            }
+            if (epilogue) {
+                acc[i][0] = applyEpilogue(*epilogue, acc[i][0], i, 0);
+                acc[i][1] = applyEpilogue(*epilogue, acc[i][1], i, 8);
+            }
+            _mm256_storeu_ps(ci, acc[i][0]);
+            _mm256_storeu_ps(ci + 8, acc[i][1]);
+        }
+    }
+};
+
+struct Avx512MicroKernel {
+    using Acc = float;
+    static constexpr size_t MR = 12, NR = 32;
+
+    IT_TARGET_AVX512 static void run(size_t kc, const float *a, const float *b,
+                                     float *c, size_t ldc, bool accumulate,
+                                     const Epilogue<float> *epilogue) {
+        __m512 acc[MR][2];
+#pragma GCC unroll 12
+        for (size_t i = 0; i < MR; ++i)
+            acc[i][0] = acc[i][1] = _mm512_setzero_ps();
+        for (size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+            __m512 b0 = _mm512_loadu_ps(b), b1 = _mm512_loadu_ps(b + 16);
+#pragma GCC unroll 12
+            for (size_t i = 0; i < MR; ++i) {
+                __m512 ai = _mm512_set1_ps(a[i]);
+                acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+                acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+            }
+        }
+#pragma GCC unroll 12
+        for (size_t i = 0; i < MR; ++i) {
+            float *ci = c + i * ldc;
+            if (accumulate) {
+                acc[i][0] = _mm512_add_ps(acc[i][0], _mm512_loadu_ps(ci));
+                acc[i][1] = _mm512_add_ps(acc[i][1], _mm512_loadu_ps(ci + 16));
+            }
+            if (epilogue) {
+                acc[i][0] = applyEpilogue(*epilogue, acc[i][0], i, 0);
+                acc[i][1] = applyEpilogue(*epilogue, acc[i][1], i, 16);
+            }
+            _mm512_storeu_ps(ci, acc[i][0]);
+            _mm512_storeu_ps(ci + 16, acc[i][1]);
+        }
+    }
+};
+#pragma GCC diagnostic pop
+#endif
+
+struct AlignedDeleter {
+    void operator()(void *ptr) const { std::free(ptr); }
+};
+
+template <typename T> std::unique_ptr<T[], AlignedDeleter> allocPack(size_t n) {
+    // aligned_alloc requires the size to be a nonzero multiple of 64
+    auto bytes = std::max((n * sizeof(T) + 63) / 64, size_t(1)) * 64;
+    auto ptr = std::aligned_alloc(64, bytes);
+    IT_ASSERT(ptr != nullptr,
+              "Failed to allocate " + std::to_string(bytes) + " bytes");
+    return std::unique_ptr<T[], AlignedDeleter>(static_cast<T *>(ptr));
+}
+
+/**
+ * @brief Columns [begin, begin + n) of C, which are op(A) times a B of their
+ * own. The slice of C is contiguous; bOffsets give the first element of every
+ * B matrix like aOffsets.
+ */
+template <typename T> struct ColumnSlice {
+    const T *b;
+    size_t bRowStride, bColStride;
+    vector<size_t> bOffsets;
+    T *c;
+    size_t begin, n;
+};
+
+/**
+ * @brief A batch of GEMMs C[b] = op(A[b]) * op(B[b]) sharing m, n and k. C is
+ * split by columns into slices, which is a single slice unless the MatMul has
+ * several Bs and outputs; aOffsets gives the first element of every A matrix,
+ * so that broadcast batches are read without being copied.
+ *
+ * The optional epilogue adds a bias, read in the type the micro-kernel
+ * computes in through strides and biasOffsets like A, and clamps C to
+ * [lo, hi].
+ */
+template <typename T> struct GemmProblem {
+    using Acc = std::conditional_t<is_half_v<T>, float, T>;
+    size_t m, n, k;
+    const T *a;
+    size_t aRowStride, aColStride;
+    vector<size_t> aOffsets;
+    vector<ColumnSlice<T>> slices;
+
+    const Acc *bias = nullptr;
+    size_t biasRowStride = 0, biasColStride = 0;
+    vector<size_t> biasOffsets;
+    Acc lo{}, hi{};
+    bool clip = false;
+};
+
+/**
+ * @brief Turns a batch of GEMMs that share B, such as [b, m, k] x [k, n], into
+ * a single GEMM over the rows of all the batches, when the batches of A and C
+ * follow each other in memory and the bias is shared or stacked like C. A
+ * large m packs every block of B once for MC rows instead of once per batch.
+ */
+template <typename T> void collapseBatches(GemmProblem<T> &prob) {
+    size_t batches = prob.aOffsets.size(), m = prob.m;
+    if (batches < 2 || prob.aColStride != 1)
+        return;
+    for (size_t b = 0; b < batches; ++b) {
+        if (prob.aOffsets[b] != b * m * prob.aRowStride ||
+            (prob.bias && prob.biasOffsets[b] != b * m * prob.biasRowStride))
+            return;
+        for (auto &slice : prob.slices) {
+            if (slice.bOffsets[b] != 0)
+                return;
+        }
+    }
+    prob.m = batches * m;
+    prob.aOffsets = {0};
+    for (auto &slice : prob.slices)
+        slice.bOffsets = {0};
+    if (prob.bias)
+        prob.biasOffsets = {0};
+}
+
+/**
+ * @brief Blocked GEMM driver. The work is split into independent (batch, MC
+ * rows, NC columns of a slice) tasks that run on up to 'threads' threads;
+ * every thread packs its own blocks of A and B into private buffers. The operands are
+ * packed in the type the micro-kernel computes in; when it is wider than T
+ * (fp16 and bf16 in fp32), each block of C is also accumulated in that type
+ * over the whole k and rounded to T once.
+ */
+template <typename T, typename MicroKernel>
+void gemm(const GemmProblem<T> &prob, int threads) {
+    using Acc = typename MicroKernel::Acc;
+    static_assert(std::is_same_v<Acc, typename GemmProblem<T>::Acc>);
+    constexpr bool widened = !std::is_same_v<T, Acc>;
+    const bool fused = prob.bias || prob.clip;
+    constexpr size_t MR = MicroKernel::MR, NR = MicroKernel::NR;
+    static_assert(MC % MR == 0 && NC % NR == 0);
+    const size_t m = prob.m, k = prob.k;
+    // (slice, first column in the slice) of every block of columns
+    vector<pair<size_t, size_t>> columnBlocks;
+    for (size_t s = 0; s < prob.slices.size(); ++s) {
+        for (size_t j0 = 0; j0 < prob.slices[s].n; j0 += NC)
+            columnBlocks.emplace_back(s, j0);
+    }
+    const size_t mBlocks = (m + MC - 1) / MC, nBlocks = columnBlocks.size();
+    const long tasks = prob.aOffsets.size() * mBlocks * nBlocks;
+
+    threads = std::min<long>(threads, tasks);
+#pragma omp parallel num_threads(threads) if (threads > 1)
+    {
+        auto aPack = allocPack<Acc>(MC * KC), bPack = allocPack<Acc>(KC * NC);
+        std::unique_ptr<Acc[], AlignedDeleter> cBuffer;
+        if constexpr (widened)
+            cBuffer = allocPack<Acc>(MC * NC);
+        Acc tile[MR * NR];
+#pragma omp for schedule(dynamic)
+        for (long task = 0; task < tasks; ++task) {
+            size_t batch = task / (mBlocks * nBlocks);
+            size_t i0 = task / nBlocks % mBlocks * MC;
+            auto [s, j0] = columnBlocks[task % nBlocks];
+            const ColumnSlice<T> &slice = prob.slices[s];
+            size_t mc = std::min(MC, m - i0), nc = std::min(NC, slice.n - j0);
+            MatrixView<T> a{prob.a + prob.aOffsets[batch], prob.aRowStride,
+                            prob.aColStride};
+            MatrixView<T> b{slice.b + slice.bOffsets[batch], slice.bRowStride,
+                            slice.bColStride};
+            T *c = slice.c + (batch * m + i0) * slice.n + j0;
+            Acc *cBlock;
+            size_t ldc;
+            if constexpr (widened) {
+                cBlock = cBuffer.get();
+                ldc = nc;
+            } else {
+                cBlock = c;
+                ldc = slice.n;
+            }
+
+            const Acc *bias =
+                prob.bias ? prob.bias + prob.biasOffsets[batch] +
+                                i0 * prob.biasRowStride +
+                                (slice.begin + j0) * prob.biasColStride
+                          : nullptr;
+            for (size_t p0 = 0; p0 < k; p0 += KC) {
+                size_t kc = std::min(KC, k - p0);
+                bool accumulate = p0 > 0, last = p0 + kc == k;
+                packA<MR>(a, m, i0, mc, p0, kc, aPack.get());
+                packB<NR>(b, slice.n, p0, kc, j0, nc, bPack.get());
+                for (size_t jr = 0; jr < nc; jr += NR) {
+                    size_t cols = std::min(NR, nc - jr);
+                    for (size_t ir = 0; ir < mc; ir += MR) {
+                        size_t rows = std::min(MR, mc - ir);
+                        const Acc *ap = aPack.get() + ir * kc;
+                        const Acc *bp = bPack.get() + jr * kc;
+                        Acc *cp = cBlock + ir * ldc + jr;
+                        Epilogue<Acc> epilogue{
+                            bias ? bias + ir * prob.biasRowStride +
+                                       jr * prob.biasColStride
+                                 : nullptr,
+                            prob.biasRowStride, prob.biasColStride, prob.lo,
+                            prob.hi, prob.clip};
+                        const Epilogue<Acc> *tail =
+                            fused && last ? &epilogue : nullptr;
+                        if (rows == MR && cols == NR) {
+                            MicroKernel::run(kc, ap, bp, cp, ldc, accumulate,
+                                             tail);
+                            continue;
+                        }
+                        // edge tile: compute a full tile aside and keep the
+                        // valid part
+                        MicroKernel::run(kc, ap, bp, tile, NR, false, nullptr);
+                        for (size_t i = 0; i < rows; ++i) {
+                            for (size_t j = 0; j < cols; ++j) {
+                                Acc &dst = cp[i * ldc + j];
+                                dst = accumulate ? dst + tile[i * NR + j]
+                                                 : tile[i * NR + j];
+                                if (tail)
+                                    dst = epilogue(dst, i, j);
+                            }
+                        }
+                    }
+                }
+            }
+            if constexpr (widened) {
+                for (size_t i = 0; i < mc; ++i)
+                    convertFromFloat(cBlock + i * ldc, c + i * slice.n, nc);
+            }
+        }
+    }
+}
+
+} // namespace
+
+class NativeMatmul : public CpuKernelWithoutConfig {
+    template <typename T>
+    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+        auto op = as<MatmulObj>(_op);
+        auto A = op->getInputs(0);
+        const auto &aDims = A->getDims();
+        // with several Bs, the outputs are the column slices of one C
+        Shape cDims = op->getOutput(0)->getDims();
+        cDims.back() = 0;
+        for (auto &output : op->getOutputs())
+            cDims.back() += output->getDims().back();
+        IT_ASSERT(aDims.size() >= 2);
+        size_t aRows = aDims[aDims.size() - 2], aCols = aDims.back();
+
+        GemmProblem<T> prob;
+        prob.m = cDims[cDims.size() - 2];
+        prob.n = cDims.back();
+        prob.k = op->getTransA() ? aRows : aCols;
+        prob.a = A->getRawDataPtr<T *>();
+        // a transposed operand is read through swapped strides
+        prob.aRowStride = op->getTransA() ? 1 : aCols;
+        prob.aColStride = op->getTransA() ? aCols : 1;
+        prob.aOffsets = matmul_batch_offsets(aDims, cDims);
+        for (size_t i = 0, begin = 0; i < op->numWeights(); ++i) {
+            auto B = op->getInputs(1 + i), C = op->getOutput(i);
+            const auto &bDims = B->getDims();
+            IT_ASSERT(bDims.size() >= 2);
+            size_t bRows = bDims[bDims.size() - 2], bCols = bDims.back();
+            IT_ASSERT(prob.k == (op->getTransB() ? bCols : bRows));
+            size_t n = C->getDims().back();
+            prob.slices.push_back({B->getRawDataPtr<T *>(),
+                                   op->getTransB() ? 1 : bCols,
+                                   op->getTransB() ? bCols : 1,
+                                   matmul_batch_offsets(bDims, cDims),
+                                   C->getRawDataPtr<T *>(), begin, n});
+            begin += n;
+        }
+        if (prob.m == 0 || prob.n == 0 || prob.aOffsets.empty())
+            return;
+
+        // fp16 and bf16 are computed in fp32
+        using Acc = typename GemmProblem<T>::Acc;
+        vector<Acc> biasBuffer;
+        if (op->hasBias()) {
+            auto bias = op->getInputs(2);
+            // aligned to the right of C, like the inputs of an element-wise
+            // operator
+            Shape biasDims(cDims.size() - bias->getRank(), 1);
+            for (auto dim : bias->getDims())
+                biasDims.push_back(dim);
+            size_t rows = biasDims[biasDims.size() - 2], cols = biasDims.back();
+            prob.biasRowStride = rows == 1 ? 0 : cols;
+            prob.biasColStride = cols == 1 ? 0 : 1;
+            prob.biasOffsets = matmul_batch_offsets(biasDims, cDims);
+            if constexpr (is_half_v<T>) {
+                biasBuffer.resize(bias->size());
+                convertToFloat(bias->getRawDataPtr<T *>(), biasBuffer.data(),
+                               biasBuffer.size());
+                prob.bias = biasBuffer.data();
+            } else {
+                prob.bias = bias->getRawDataPtr<T *>();
+            }
+        }
+        if (op->getClipMin() || op->getClipMax()) {
+            // bounds beyond the range of Acc clip nothing, like in the Clip
+            // kernel
+            using Limits = std::numeric_limits<Acc>;
+            Acc lowest = Limits::has_infinity ? Acc(-Limits::infinity())
+                                              : Limits::lowest();
+            Acc highest = Limits::has_infinity ? Limits::infinity()
+                                               : Limits::max();
+            auto min = op->getClipMin(), max = op->getClipMax();
+            prob.lo = min && *min > float(lowest) ? Acc(*min) : lowest;
+            prob.hi = max && *max < float(highest) ? Acc(*max) : highest;
+            prob.clip = true;
+        }
+        if (prob.k == 0) {
+            if (!op->hasEpilogue()) {
+                for (auto &output : op->getOutputs())
+                    std::fill_n(output->getRawDataPtr<T *>(), output->size(),
+                                T(0));
+                return;
+            }
+            // C is the epilogue of zeros
+            vector<Acc> row(prob.n);
+            for (size_t batch = 0; batch < prob.aOffsets.size(); ++batch) {
+                for (size_t i = 0; i < prob.m; ++i) {
+                    Epilogue<Acc> epilogue{
+                        prob.bias ? prob.bias + prob.biasOffsets[batch] +
+                                        i * prob.biasRowStride
+                                  : nullptr,
+                        0, prob.biasColStride, prob.lo, prob.hi, prob.clip};
+                    for (size_t j = 0; j < prob.n; ++j)
+                        row[j] = epilogue(Acc(0), 0, j);
+                    for (auto &slice : prob.slices) {
+                        T *c = slice.c + (batch * prob.m + i) * slice.n;
+                        if constexpr (is_half_v<T>)
+                            convertFromFloat(row.data() + slice.begin, c,
+                                             slice.n);
+                        else
+                            std::copy_n(row.begin() + slice.begin, slice.n, c);
+                    }
+                }
+            }
+            return;
+        }
+
+        collapseBatches(prob);
+        int threads = context->getNumThreads();
+#if IT_X86
+        if constexpr (std::is_same_v<Acc, float>) {
+            switch (cpuIsa()) {
+            case CpuIsa::Avx512:
+                return gemm<T, Avx512MicroKernel>(prob, threads);
+            case CpuIsa::Avx2:
+                return gemm<T, Avx2MicroKernel>(prob, threads);
+            default:
+                break;
+            }
+        }
+#endif
+        gemm<T, GenericMicroKernel<Acc>>(prob, threads);
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        // Float32, Int32, Int64, Float16, Double, UInt32 and BFloat16
+        dispatchDType(_op->getDType(), DTypes<1, 6, 7, 10, 11, 12, 16>(),
+                      [&](auto tag) {
+                          using T = typename decltype(tag)::type;
+                          doCompute<T>(_op, context);
+                      });
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::MatMul, NativeMatmul, "Matmul_CPU");
+
+} // namespace infini
@@ -0,0 +1,90 @@
+#include "operators/quantize_linear.h"
+#include "core/kernel.h"
+#include "utils/parallel.h"
+#include "utils/simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace infini {
+
+namespace {
+
+void quantizeScalar(const float *x, int8_t *y, size_t n, float scale,
+                    int zeroPoint) {
+    for (size_t i = 0; i < n; ++i) {
+        float q = std::nearbyint(x[i] / scale) + float(zeroPoint);
+        y[i] = int8_t(std::clamp(q, -128.f, 127.f));
+    }
+}
+
+#if IT_X86
+// GCC 12 warns about the _mm512_undefined_* placeholders inside the AVX-512
+// conversion intrinsics.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+// x / scale is clamped before the conversion to int32, which rounds to
+// nearest even, and the sum with the zero point saturates to int8 like the
+// scalar loop does.
+IT_TARGET_AVX2 void quantizeAvx2(const float *x, int8_t *y, size_t n,
+                                 float scale, int zeroPoint) {
+    __m256 vScale = _mm256_set1_ps(scale), lo = _mm256_set1_ps(-256.f),
+           hi = _mm256_set1_ps(256.f);
+    __m256i vZero = _mm256_set1_epi32(zeroPoint);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_div_ps(_mm256_loadu_ps(x + i), vScale);
+        v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+        __m256i q = _mm256_add_epi32(_mm256_cvtps_epi32(v), vZero);
+        __m128i q16 = _mm_packs_epi32(_mm256_castsi256_si128(q),
+                                      _mm256_extracti128_si256(q, 1));
+        _mm_storel_epi64((__m128i *)(y + i), _mm_packs_epi16(q16, q16));
+    }
+    quantizeScalar(x + i, y + i, n - i, scale, zeroPoint);
+}
+
+IT_TARGET_AVX512 void quantizeAvx512(const float *x, int8_t *y, size_t n,
+                                     float scale, int zeroPoint) {
+    __m512 vScale = _mm512_set1_ps(scale), lo = _mm512_set1_ps(-256.f),
+           hi = _mm512_set1_ps(256.f);
+    __m512i vZero = _mm512_set1_epi32(zeroPoint);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_div_ps(_mm512_loadu_ps(x + i), vScale);
+        v = _mm512_min_ps(_mm512_max_ps(v, lo), hi);
+        __m512i q = _mm512_add_epi32(_mm512_cvtps_epi32(v), vZero);
+        _mm_storeu_si128((__m128i *)(y + i), _mm512_cvtsepi32_epi8(q));
+    }
+    quantizeScalar(x + i, y + i, n - i, scale, zeroPoint);
+}
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace
+
+class NativeQuantizeLinear : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<QuantizeLinearObj>(_op);
+        auto x = op->getInputs(0)->getRawDataPtr<float *>();
+        auto y = op->getOutput()->getRawDataPtr<int8_t *>();
+        float scale = op->getQuant().scales[0];
+        int zeroPoint = op->getQuant().zeroPoints[0];
+        auto quantize = quantizeScalar;
+#if IT_X86
+        if (cpuIsa() == CpuIsa::Avx512)
+            quantize = quantizeAvx512;
+        else if (cpuIsa() == CpuIsa::Avx2)
+            quantize = quantizeAvx2;
+#endif
+        parallelFor(context, op->getOutput()->size(), PARALLEL_GRAIN,
+                    [&](size_t begin, size_t end) {
+                        quantize(x + begin, y + begin, end - begin, scale,
+                                 zeroPoint);
+                    });
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::QuantizeLinear, NativeQuantizeLinear,
+                "QuantizeLinear_CPU");
+
+} // namespace infini
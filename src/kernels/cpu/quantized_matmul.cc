@@ -0,0 +1,328 @@
+#include "operators/quantized_matmul.h"
+#include "core/kernel.h"
+#include "utils/operator_utils.h"
+#include "utils/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace infini {
+
+namespace {
+
+// Every task multiplies all the rows of A with NC columns of B, which are
+// packed once over the whole k. NC must be a multiple of every NR below.
+constexpr size_t NC = 128;
+
+/**
+ * @brief A batch of int8 GEMMs and the epilogue that turns their int32 sums
+ * into C. A is read shifted to unsigned, A + 128, as the VNNI dot products
+ * require, and so is its zero point, which leaves A - aZero unchanged.
+ */
+struct QGemmProblem {
+    size_t m, n, k;
+    const int8_t *a, *b;
+    size_t aRowStride, aColStride, bRowStride, bColStride;
+    vector<size_t> aOffsets, bOffsets;
+    int32_t aZero;
+    // per column of C
+    vector<int32_t> bZeros;
+    // C = scales * (A - aZero)(B - bZeros), rounded to int8 and offset by
+    // cZero when requantized
+    vector<float> scales;
+    bool requantize;
+    int32_t cZero;
+    void *c;
+};
+
+/**
+ * @brief Portable micro-kernel. The MR x NR tile of int32 sums of an A panel
+ * and a B panel, where each of the kGroups steps holds G = 1 element of every
+ * row of A and column of B.
+ */
+struct GenericMicroKernel {
+    using TA = int32_t;
+    using TB = int32_t;
+    static constexpr size_t MR = 4, NR = 16, G = 1;
+
+    static void run(size_t kGroups, const int32_t *a, const int32_t *b,
+                    int32_t *c) {
+        int32_t acc[MR][NR] = {};
+        for (size_t p = 0; p < kGroups; ++p, a += MR, b += NR) {
+            for (size_t i = 0; i < MR; ++i) {
+                for (size_t j = 0; j < NR; ++j)
+                    acc[i][j] += a[i] * b[j];
+            }
+        }
+        std::memcpy(c, acc, sizeof(acc));
+    }
+};
+
+#if IT_X86
+// Broadcasts the G elements of a row of A in one 32-bit lane
+inline int32_t loadGroup(const void *p) {
+    int32_t x;
+    std::memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+// vpmaddubsw would multiply the bytes directly, but it saturates its int16
+// sums of two u8 x s8 products, so the operands are widened to int16 and
+// multiplied exactly with vpmaddwd.
+struct Avx2MicroKernel {
+    using TA = int16_t;
+    using TB = int16_t;
+    static constexpr size_t MR = 6, NR = 16, G = 2;
+
+    IT_TARGET_AVX2 static void run(size_t kGroups, const int16_t *a,
+                                   const int16_t *b, int32_t *c) {
+        __m256i acc[MR][2];
+#pragma GCC unroll 6
+        for (size_t i = 0; i < MR; ++i)
+            acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+        for (size_t p = 0; p < kGroups; ++p, a += MR * G, b += NR * G) {
+            __m256i b0 = _mm256_loadu_si256((const __m256i *)b);
+            __m256i b1 = _mm256_loadu_si256((const __m256i *)(b + 16));
+#pragma GCC unroll 6
+            for (size_t i = 0; i < MR; ++i) {
+                __m256i ai = _mm256_set1_epi32(loadGroup(a + i * G));
+                acc[i][0] =
+                    _mm256_add_epi32(acc[i][0], _mm256_madd_epi16(ai, b0));
+                acc[i][1] =
+                    _mm256_add_epi32(acc[i][1], _mm256_madd_epi16(ai, b1));
+            }
+        }
+#pragma GCC unroll 6
+        for (size_t i = 0; i < MR; ++i) {
+            _mm256_storeu_si256((__m256i *)(c + i * NR), acc[i][0]);
+            _mm256_storeu_si256((__m256i *)(c + i * NR + 8), acc[i][1]);
+        }
+    }
+};
+
+struct VnniMicroKernel {
+    using TA = uint8_t;
+    using TB = int8_t;
+    static constexpr size_t MR = 12, NR = 32, G = 4;
+
+    IT_TARGET_AVX512_VNNI static void run(size_t kGroups, const uint8_t *a,
+                                          const int8_t *b, int32_t *c) {
+        __m512i acc[MR][2];
+#pragma GCC unroll 12
+        for (size_t i = 0; i < MR; ++i)
+            acc[i][0] = acc[i][1] = _mm512_setzero_si512();
+        for (size_t p = 0; p < kGroups; ++p, a += MR * G, b += NR * G) {
+            __m512i b0 = _mm512_loadu_si512(b), b1 = _mm512_loadu_si512(b + 64);
+#pragma GCC unroll 12
+            for (size_t i = 0; i < MR; ++i) {
+                __m512i ai = _mm512_set1_epi32(loadGroup(a + i * G));
+                acc[i][0] = _mm512_dpbusd_epi32(acc[i][0], ai, b0);
+                acc[i][1] = _mm512_dpbusd_epi32(acc[i][1], ai, b1);
+            }
+        }
+#pragma GCC unroll 12
+        for (size_t i = 0; i < MR; ++i) {
+            _mm512_storeu_si512(c + i * NR, acc[i][0]);
+            _mm512_storeu_si512(c + i * NR + 16, acc[i][1]);
+        }
+    }
+};
+#endif
+
+/**
+ * @brief Packs rows [i0, i0 + MR) of A, shifted to unsigned, into a panel of
+ * k groups of G consecutive elements of every row. Rows beyond m and columns
+ * beyond k are padded with zeros. rowSums receives the sum of every row.
+ */
+template <typename Kernel>
+void packA(const QGemmProblem &prob, const int8_t *a, size_t i0,
+           typename Kernel::TA *dst, int32_t *rowSums) {
+    constexpr size_t MR = Kernel::MR, G = Kernel::G;
+    size_t rows = std::min(MR, prob.m - i0);
+    size_t kPadded = (prob.k + G - 1) / G * G;
+    for (size_t i = 0; i < MR; ++i) {
+        int32_t sum = 0;
+        for (size_t p = 0; p < kPadded; ++p) {
+            int32_t x = 0;
+            if (i < rows && p < prob.k) {
+                x = int32_t(a[(i0 + i) * prob.aRowStride +
+                              p * prob.aColStride]) +
+                    128;
+                sum += x;
+            }
+            dst[p / G * MR * G + i * G + p % G] = x;
+        }
+        rowSums[i] = sum;
+    }
+}
+
+/**
+ * @brief Packs columns [j0, j0 + NR) of B into a panel of k groups of G
+ * consecutive elements of every column, padded like packA. colTerms receives
+ * the part of the epilogue that depends on the column only.
+ */
+template <typename Kernel>
+void packB(const QGemmProblem &prob, const int8_t *b, size_t j0,
+           typename Kernel::TB *dst, int32_t *colTerms) {
+    constexpr size_t NR = Kernel::NR, G = Kernel::G;
+    size_t cols = std::min(NR, prob.n - j0);
+    size_t kPadded = (prob.k + G - 1) / G * G;
+    for (size_t j = 0; j < NR; ++j) {
+        int32_t sum = 0;
+        for (size_t p = 0; p < kPadded; ++p) {
+            int32_t x = 0;
+            if (j < cols && p < prob.k) {
+                x = b[p * prob.bRowStride + (j0 + j) * prob.bColStride];
+                sum += x;
+            }
+            dst[p / G * NR * G + j * G + p % G] = x;
+        }
+        colTerms[j] =
+            j < cols ? prob.aZero * (sum - int32_t(prob.k) *
+                                               prob.bZeros[j0 + j])
+                     : 0;
+    }
+}
+
+/**
+ * @brief Writes the valid rows x cols of a tile of sums S to C at (i0, j0):
+ * (A - aZero)(B - bZero) = S - bZero * rowSum - aZero * (colSum - k * bZero),
+ * scaled and requantized or dequantized. S - bZero * rowSum, the column term
+ * and the result are all sums of k products bounded like the result, so they
+ * fit in int32 for k up to QuantizedMatmulObj::getMaxK().
+ */
+template <size_t NR>
+void storeTile(const QGemmProblem &prob, size_t batch, size_t i0, size_t rows,
+               size_t j0, size_t cols, const int32_t *tile,
+               const int32_t *rowSums, const int32_t *colTerms) {
+    size_t offset = (batch * prob.m + i0) * prob.n + j0;
+    for (size_t i = 0; i < rows; ++i, offset += prob.n) {
+        for (size_t j = 0; j < cols; ++j) {
+            int32_t sum = tile[i * NR + j] -
+                          prob.bZeros[j0 + j] * rowSums[i] - colTerms[j];
+            float x = float(sum) * prob.scales[j0 + j];
+            if (prob.requantize) {
+                float q = std::nearbyint(x) + float(prob.cZero);
+                static_cast<int8_t *>(prob.c)[offset + j] =
+                    int8_t(std::clamp(q, -128.f, 127.f));
+            } else {
+                static_cast<float *>(prob.c)[offset + j] = x;
+            }
+        }
+    }
+}
+
+/**
+ * @brief The int8 GEMM driver. A is packed once up front; the work is then
+ * split into (batch, NC columns) tasks, each of which packs its columns of B
+ * and walks every panel of A, on up to 'threads' threads.
+ */
+template <typename Kernel>
+void quantizedGemm(const QGemmProblem &prob, int threads) {
+    using TA = typename Kernel::TA;
+    using TB = typename Kernel::TB;
+    constexpr size_t MR = Kernel::MR, NR = Kernel::NR, G = Kernel::G;
+    static_assert(NC % NR == 0);
+    const size_t m = prob.m, n = prob.n;
+    const size_t kGroups = (prob.k + G - 1) / G;
+    const size_t mPanels = (m + MR - 1) / MR, nBlocks = (n + NC - 1) / NC;
+    const size_t batch = prob.aOffsets.size();
+    const size_t aPanelSize = MR * kGroups * G, bPanelSize = NR * kGroups * G;
+
+    vector<TA> aPack(batch * mPanels * aPanelSize);
+    vector<int32_t> rowSums(batch * mPanels * MR);
+    const long aTasks = batch * mPanels;
+#pragma omp parallel for num_threads(threads) if (threads > 1)
+    for (long task = 0; task < aTasks; ++task)
+        packA<Kernel>(prob, prob.a + prob.aOffsets[task / mPanels],
+                      task % mPanels * MR, aPack.data() + task * aPanelSize,
+                      rowSums.data() + task * MR);
+
+    const long tasks = batch * nBlocks;
+    threads = std::min<long>(threads, tasks);
+#pragma omp parallel num_threads(threads) if (threads > 1)
+    {
+        vector<TB> bPack(NC / NR * bPanelSize);
+        int32_t colTerms[NC];
+        int32_t tile[MR * NR];
+#pragma omp for schedule(dynamic)
+        for (long task = 0; task < tasks; ++task) {
+            size_t b = task / nBlocks, j0 = task % nBlocks * NC;
+            size_t nc = std::min(NC, n - j0);
+            for (size_t jr = 0; jr < nc; jr += NR)
+                packB<Kernel>(prob, prob.b + prob.bOffsets[b], j0 + jr,
+                              bPack.data() + jr / NR * bPanelSize,
+                              colTerms + jr);
+            for (size_t ip = 0; ip < mPanels; ++ip) {
+                size_t panel = b * mPanels + ip;
+                const TA *ap = aPack.data() + panel * aPanelSize;
+                for (size_t jr = 0; jr < nc; jr += NR) {
+                    Kernel::run(kGroups, ap,
+                                bPack.data() + jr / NR * bPanelSize, tile);
+                    storeTile<NR>(prob, b, ip * MR, std::min(MR, m - ip * MR),
+                                  j0 + jr, std::min(NR, nc - jr), tile,
+                                  rowSums.data() + panel * MR, colTerms + jr);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+class NativeQuantizedMatmul : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<QuantizedMatmulObj>(_op);
+        auto A = op->getInputs(0), B = op->getInputs(1), C = op->getOutput();
+        const auto &aDims = A->getDims(), &bDims = B->getDims(),
+                   &cDims = C->getDims();
+        size_t aCols = aDims.back(), bCols = bDims.back();
+
+        QGemmProblem prob;
+        prob.m = cDims[cDims.size() - 2];
+        prob.n = cDims.back();
+        prob.k = op->getTransA() ? aDims[aDims.size() - 2] : aCols;
+        // the sums of (u8 - zero) * (s8 - zero) products fit in int32
+        IT_ASSERT(prob.k <= op->getMaxK(),
+                  "QuantizedMatmul supports k up to " +
+                      std::to_string(op->getMaxK()) + " with these zero points");
+        prob.a = A->getRawDataPtr<int8_t *>();
+        prob.b = B->getRawDataPtr<int8_t *>();
+        prob.c = C->getRawDataPtr<void *>();
+        prob.aRowStride = op->getTransA() ? 1 : aCols;
+        prob.aColStride = op->getTransA() ? aCols : 1;
+        prob.bRowStride = op->getTransB() ? 1 : bCols;
+        prob.bColStride = op->getTransB() ? bCols : 1;
+        prob.aOffsets = matmul_batch_offsets(aDims, cDims);
+        prob.bOffsets = matmul_batch_offsets(bDims, cDims);
+
+        const auto &aQuant = op->getAQuant(), &bQuant = op->getBQuant();
+        const auto &cQuant = op->getCQuant();
+        prob.aZero = aQuant.zeroPoints[0] + 128;
+        prob.requantize = cQuant.has_value();
+        prob.cZero = cQuant ? cQuant->zeroPoints[0] : 0;
+        float cScale = cQuant ? cQuant->scales[0] : 1.f;
+        prob.bZeros.resize(prob.n);
+        prob.scales.resize(prob.n);
+        for (size_t j = 0; j < prob.n; ++j) {
+            size_t channel = bQuant.size() == 1 ? 0 : j;
+            prob.bZeros[j] = bQuant.zeroPoints[channel];
+            prob.scales[j] = aQuant.scales[0] * bQuant.scales[channel] / cScale;
+        }
+
+        int threads = context->getNumThreads();
+#if IT_X86
+        if (cpuHasAvx512Vnni())
+            return quantizedGemm<VnniMicroKernel>(prob, threads);
+        if (cpuIsa() != CpuIsa::Scalar)
+            return quantizedGemm<Avx2MicroKernel>(prob, threads);
+#endif
+        quantizedGemm<GenericMicroKernel>(prob, threads);
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::QuantizedMatMul, NativeQuantizedMatmul,
+                "QuantizedMatmul_CPU");
+
+} // namespace infini
@@ -1,60 +1,288 @@
 #include "operators/transpose.h"
 #include "core/kernel.h"
+#include "utils/parallel.h"
+#include "utils/simd.h"
+#include <cstring>
 
 namespace infini {
 
-inline Shape idx2Pos(const Shape &shape, size_t idx) {
-    Shape pos = Shape(shape.size(), 0);
-    auto rest = idx, curDimId = shape.size() - 1;
-    while (rest > 0) {
-        pos[curDimId] = rest % shape[curDimId];
-        rest /= shape[curDimId];
-        curDimId--;
+namespace {
+
+// Side of the square tiles of a 2D transpose, small enough for a tile of the
+// input and one of the output to stay in L1
+constexpr size_t TILE = 64;
+
+/**
+ * @brief A transpose in which size-1 dims are dropped and input dims that
+ * stay neighbours in the output are merged, so that every remaining dim
+ * breaks contiguity on one side.
+ */
+struct TransposePlan {
+    vector<size_t> dims; // of the input
+    vector<size_t> perm; // output dim i is input dim perm[i]
+    vector<size_t> inStrides, outStrides; // indexed by input dim
+
+    TransposePlan(const Shape &inDims, const vector<int> &permute) {
+        // walk the output and merge an input dim into the previous one when
+        // it also follows it in the input, skipping size-1 dims
+        vector<size_t> firstOf, lastOf; // input dims merged, in output order
+        for (int d : permute) {
+            if (inDims[d] == 1)
+                continue;
+            if (!lastOf.empty() && nextKept(inDims, lastOf.back()) == size_t(d)) {
+                lastOf.back() = d;
+            } else {
+                firstOf.push_back(d);
+                lastOf.push_back(d);
+            }
+        }
+        // number the merged dims in input order
+        vector<size_t> byInput(firstOf.size());
+        for (size_t i = 0; i < firstOf.size(); ++i)
+            byInput[i] = i;
+        std::sort(byInput.begin(), byInput.end(), [&](size_t x, size_t y) {
+            return firstOf[x] < firstOf[y];
+        });
+        dims.resize(firstOf.size());
+        perm.resize(firstOf.size());
+        for (size_t i = 0; i < byInput.size(); ++i) {
+            size_t o = byInput[i];
+            dims[i] = 1;
+            for (size_t d = firstOf[o]; d <= lastOf[o]; ++d)
+                dims[i] *= inDims[d];
+            perm[o] = i;
+        }
+
+        size_t rank = dims.size();
+        inStrides.resize(rank);
+        outStrides.resize(rank);
+        for (size_t i = rank, stride = 1; i-- > 0;) {
+            inStrides[i] = stride;
+            stride *= dims[i];
+        }
+        for (size_t i = rank, stride = 1; i-- > 0;) {
+            outStrides[perm[i]] = stride;
+            stride *= dims[perm[i]];
+        }
     }
-    return pos;
+
+  private:
+    // the next input dim after d that is not of size 1
+    static size_t nextKept(const Shape &inDims, size_t d) {
+        do {
+            ++d;
+        } while (d < inDims.size() && inDims[d] == 1);
+        return d;
+    }
+};
+
+/**
+ * @brief The offset of the 'index'-th element of a row-major walk over
+ * 'dims', under 'strides'.
+ */
+size_t offsetOf(size_t index, const vector<size_t> &dims,
+                const vector<size_t> &strides) {
+    size_t offset = 0;
+    for (size_t i = dims.size(); i-- > 0;) {
+        offset += index % dims[i] * strides[i];
+        index /= dims[i];
+    }
+    return offset;
 }
 
-class NaiveTranspose : public CpuKernelWithoutConfig {
-    template <typename T>
-    void doCompute(const Operator &_op, const RuntimeObj *context) const {
-        auto op = as<TransposeObj>(_op);
-        auto inputs = op->getInputs(), outputs = op->getOutputs();
-        const auto &inDim = inputs[0]->getDims();
-        const auto &perm = op->getPermute();
-
-        size_t inSize = inputs[0]->size();
-        auto inPtr = inputs[0]->getRawDataPtr<T *>(),
-             outPtr = outputs[0]->getRawDataPtr<T *>();
-        // #pragma omp parallel for
-        for (size_t inIdx = 0; inIdx < inSize; ++inIdx) {
-            auto posInput = idx2Pos(inDim, inIdx);
-            int outIdx = 0;
-            for (size_t j = 0, jEnd = perm.size(); j < jEnd; ++j) {
-                outIdx = outIdx * inDim[perm[j]] + posInput[perm[j]];
-            }
-            outPtr[outIdx] = inPtr[inIdx];
+// dst[j * dstStride + i] = src[i * srcStride + j] for a rows x cols block
+template <typename T>
+void transposeTile(const T *src, size_t srcStride, T *dst, size_t dstStride,
+                   size_t rows, size_t cols) {
+    for (size_t j = 0; j < cols; ++j) {
+        for (size_t i = 0; i < rows; ++i)
+            dst[j * dstStride + i] = src[i * srcStride + j];
+    }
+}
+
+#if IT_X86
+// Transposes an 8x8 block of 32-bit elements in registers.
+IT_TARGET_AVX2 inline void transpose8x8(const uint32_t *src, size_t srcStride,
+                                        uint32_t *dst, size_t dstStride) {
+    auto s = reinterpret_cast<const float *>(src);
+    auto d = reinterpret_cast<float *>(dst);
+    __m256 r0 = _mm256_loadu_ps(s + 0 * srcStride);
+    __m256 r1 = _mm256_loadu_ps(s + 1 * srcStride);
+    __m256 r2 = _mm256_loadu_ps(s + 2 * srcStride);
+    __m256 r3 = _mm256_loadu_ps(s + 3 * srcStride);
+    __m256 r4 = _mm256_loadu_ps(s + 4 * srcStride);
+    __m256 r5 = _mm256_loadu_ps(s + 5 * srcStride);
+    __m256 r6 = _mm256_loadu_ps(s + 6 * srcStride);
+    __m256 r7 = _mm256_loadu_ps(s + 7 * srcStride);
+    // interleave pairs of rows, then pairs of pairs, then 128-bit halves
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+    r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    r4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    r5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    r6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    r7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm256_storeu_ps(d + 0 * dstStride, _mm256_permute2f128_ps(r0, r4, 0x20));
+    _mm256_storeu_ps(d + 1 * dstStride, _mm256_permute2f128_ps(r1, r5, 0x20));
+    _mm256_storeu_ps(d + 2 * dstStride, _mm256_permute2f128_ps(r2, r6, 0x20));
+    _mm256_storeu_ps(d + 3 * dstStride, _mm256_permute2f128_ps(r3, r7, 0x20));
+    _mm256_storeu_ps(d + 4 * dstStride, _mm256_permute2f128_ps(r0, r4, 0x31));
+    _mm256_storeu_ps(d + 5 * dstStride, _mm256_permute2f128_ps(r1, r5, 0x31));
+    _mm256_storeu_ps(d + 6 * dstStride, _mm256_permute2f128_ps(r2, r6, 0x31));
+    _mm256_storeu_ps(d + 7 * dstStride, _mm256_permute2f128_ps(r3, r7, 0x31));
+}
+
+IT_TARGET_AVX2 void transposeTileAvx2(const uint32_t *src, size_t srcStride,
+                                      uint32_t *dst, size_t dstStride,
+                                      size_t rows, size_t cols) {
+    size_t i = 0;
+    for (; i + 8 <= rows; i += 8) {
+        size_t j = 0;
+        for (; j + 8 <= cols; j += 8)
+            transpose8x8(src + i * srcStride + j, srcStride,
+                         dst + j * dstStride + i, dstStride);
+        transposeTile(src + i * srcStride + j, srcStride,
+                      dst + j * dstStride + i, dstStride, 8, cols - j);
+    }
+    transposeTile(src + i * srcStride, srcStride, dst + i, dstStride,
+                  rows - i, cols);
+}
+#endif
+
+/**
+ * @brief Moves input dim q to the innermost position, with the innermost
+ * input dim l = rank - 1 elsewhere: for every index of the other (batch)
+ * dims, the q x l plane is transposed tile by tile. The tiles are split
+ * across threads.
+ */
+template <typename T>
+void transposePlanes(const RuntimeObj *context, const TransposePlan &plan,
+                     const T *src, T *dst) {
+    size_t rank = plan.dims.size(), q = plan.perm[rank - 1], l = rank - 1;
+    vector<size_t> batchDims, srcStrides, dstStrides;
+    for (size_t d = 0; d < rank; ++d) {
+        if (d != q && d != l) {
+            batchDims.push_back(plan.dims[d]);
+            srcStrides.push_back(plan.inStrides[d]);
+            dstStrides.push_back(plan.outStrides[d]);
         }
     }
+    size_t rows = plan.dims[q], cols = plan.dims[l];
+    size_t srcStride = plan.inStrides[q], dstStride = plan.outStrides[l];
+    size_t rowTiles = (rows + TILE - 1) / TILE, colTiles = (cols + TILE - 1) / TILE;
+    size_t planeTiles = rowTiles * colTiles;
+    size_t tasks = planeTiles;
+    for (auto dim : batchDims)
+        tasks *= dim;
+
+    void (*tile)(const T *, size_t, T *, size_t, size_t, size_t) =
+        transposeTile<T>;
+#if IT_X86
+    if constexpr (sizeof(T) == 4) {
+        if (cpuIsa() != CpuIsa::Scalar)
+            tile = transposeTileAvx2;
+    }
+#endif
+    parallelFor(context, tasks, PARALLEL_GRAIN / (TILE * TILE),
+                [&](size_t begin, size_t end) {
+                    for (size_t task = begin; task < end; ++task) {
+                        size_t batch = task / planeTiles;
+                        size_t i0 = task % planeTiles / colTiles * TILE;
+                        size_t j0 = task % colTiles * TILE;
+                        const T *s = src +
+                                     offsetOf(batch, batchDims, srcStrides) +
+                                     i0 * srcStride + j0;
+                        T *d = dst + offsetOf(batch, batchDims, dstStrides) +
+                               j0 * dstStride + i0;
+                        tile(s, srcStride, d, dstStride,
+                             std::min(TILE, rows - i0),
+                             std::min(TILE, cols - j0));
+                    }
+                });
+}
 
+/**
+ * @brief Copies the rows of the innermost input dim, which stays innermost
+ * in the output, in output order.
+ */
+void transposeRows(const RuntimeObj *context, const TransposePlan &plan,
+                   const char *src, char *dst, size_t elemSize) {
+    size_t rank = plan.dims.size();
+    size_t rowBytes = plan.dims[rank - 1] * elemSize;
+    vector<size_t> outDims, srcStrides;
+    for (size_t i = 0; i + 1 < rank; ++i) {
+        outDims.push_back(plan.dims[plan.perm[i]]);
+        srcStrides.push_back(plan.inStrides[plan.perm[i]] * elemSize);
+    }
+    size_t rows = 1;
+    for (auto dim : outDims)
+        rows *= dim;
+    parallelFor(context, rows, PARALLEL_GRAIN * elemSize / rowBytes + 1,
+                [&](size_t begin, size_t end) {
+                    for (size_t row = begin; row < end; ++row)
+                        std::memcpy(dst + row * rowBytes,
+                                    src + offsetOf(row, outDims, srcStrides),
+                                    rowBytes);
+                });
+}
+
+template <typename T>
+void transpose(const RuntimeObj *context, const TransposePlan &plan,
+               const void *src, void *dst, size_t n) {
+    size_t rank = plan.dims.size();
+    if (rank <= 1) {
+        // nothing moves
+        if (src != dst)
+            parallelFor(context, n, PARALLEL_GRAIN,
+                        [&](size_t begin, size_t end) {
+                            std::memcpy(static_cast<T *>(dst) + begin,
+                                        static_cast<const T *>(src) + begin,
+                                        (end - begin) * sizeof(T));
+                        });
+    } else if (plan.perm[rank - 1] == rank - 1) {
+        transposeRows(context, plan, static_cast<const char *>(src),
+                      static_cast<char *>(dst), sizeof(T));
+    } else {
+        transposePlanes(context, plan, static_cast<const T *>(src),
+                        static_cast<T *>(dst));
+    }
+}
+
+} // namespace
+
+class NativeTranspose : public CpuKernelWithoutConfig {
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
-#define CASE(N)                                                                \
-    case N:                                                                    \
-        doCompute<DT<N>::t>(_op, context)
-
-        int dataTypeIdx = _op->getDType().getIndex();
-        switch (dataTypeIdx) {
-            CASE(1); // DataType::Float32
-            break;
-            CASE(12); // DataType::UInt32
-            break;
+        auto op = as<TransposeObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        TransposePlan plan(input->getDims(), op->getPermute());
+        auto src = input->getRawDataPtr<void *>();
+        auto dst = output->getRawDataPtr<void *>();
+        size_t n = input->size();
+        if (n == 0)
+            return;
+        // only the size of the elements matters
+        switch (input->getDType().getSize()) {
+        case 1:
+            return transpose<uint8_t>(context, plan, src, dst, n);
+        case 2:
+            return transpose<uint16_t>(context, plan, src, dst, n);
+        case 4:
+            return transpose<uint32_t>(context, plan, src, dst, n);
+        case 8:
+            return transpose<uint64_t>(context, plan, src, dst, n);
         default:
             IT_TODO_HALT();
         }
     }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Transpose, NaiveTranspose,
-                "TransposeNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, NativeTranspose,
+                "Transpose_CPU");
 
 } // namespace infini
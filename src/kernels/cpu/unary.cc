@@ -1,15 +1,33 @@
 #include "operators/unary.h"
 #include "core/kernel.h"
+#include "utils/parallel.h"
+#include "utils/simd.h"
+#include <limits>
 
 namespace infini
 {
     class NativeUnary : public CpuKernelWithoutConfig
     {
-        template <typename T>
-        static T reluCompute(T val)
+        // The ops are functors so that the loops can inline them, with an
+        // overload for each vector type of utils/simd.h.
+        struct ReluOp
         {
-            return std::max(T(0), val);
-        }
+            template <typename T>
+            T operator()(T val) const
+            {
+                return std::max(T(0), val);
+            }
+#if IT_X86
+            IT_TARGET_AVX2 __m256 operator()(__m256 val) const
+            {
+                return _mm256_max_ps(val, _mm256_setzero_ps());
+            }
+            IT_TARGET_AVX512 __m512 operator()(__m512 val) const
+            {
+                return _mm512_max_ps(val, _mm512_setzero_ps());
+            }
+#endif
+        };
 
         template <typename T>
         void doCompute(const Operator &_op, const RuntimeObj *context) const
@@ -18,48 +36,66 @@ namespace infini
             T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
             T *outptr = op->getOutput()->getRawDataPtr<T *>();
 
-            auto outDim = op->getOutput()->getDims();
             auto n = op->getOutput()->size();
-
-            T (*_doCompute)
-            (T val);
             switch (op->getOpType().underlying())
             {
             case OpType::Relu:
-                _doCompute = reluCompute<T>;
+                parallelFor(context, n, PARALLEL_GRAIN,
+                            [&](size_t begin, size_t end)
+                            {
+                                vectorizedUnary(inptr + begin, outptr + begin,
+                                                end - begin, ReluOp());
+                            });
                 break;
             default:
                 IT_TODO_HALT();
             }
-
-            for (size_t offset = 0; offset < n; offset++)
-            {
-                outptr[offset] = _doCompute(inptr[offset]);
-            }
         }
 
         void compute(const Operator &_op,
                      const RuntimeObj *context) const override
         {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
-            {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
-            }
+            dispatchDType(_op->getDType(), ArithmeticDTypes(),
+                          [&](auto tag)
+                          {
+                              using T = typename decltype(tag)::type;
+                              doCompute<T>(_op, context);
+                          });
         }
+
+        bool supportInplace() const override { return true; }
     };
 
     class Clip : public CpuKernelWithoutConfig
     {
+        // Clamps with a max and a min, which compile to branchless selects.
+        // A missing bound is infinite. NaNs pass through like they do with
+        // the vector max/min, which return their second operand when either
+        // is a NaN.
+        template <typename T>
+        struct ClipOp
+        {
+            T lo, hi;
+
+            T operator()(T val) const
+            {
+                val = lo > val ? lo : val;
+                return hi < val ? hi : val;
+            }
+#if IT_X86
+            IT_TARGET_AVX2 __m256 operator()(__m256 val) const
+            {
+                return _mm256_min_ps(_mm256_set1_ps(hi),
+                                     _mm256_max_ps(_mm256_set1_ps(lo), val));
+            }
+            IT_TARGET_AVX512 __m512 operator()(__m512 val) const
+            {
+                return _mm512_min_ps(_mm512_set1_ps(hi),
+                                     _mm512_max_ps(_mm512_set1_ps(lo), val));
+            }
+#endif
+        };
+
         template <typename T>
         void doCompute(const Operator &_op, const RuntimeObj *context) const
         {
@@ -69,34 +105,38 @@ namespace infini
             auto minValue = op->getMin();
             auto maxValue = op->getMax();
 
+            using Limits = std::numeric_limits<T>;
+            T lowest = Limits::has_infinity ? T(-Limits::infinity())
+                                            : Limits::lowest();
+            T highest = Limits::has_infinity ? Limits::infinity()
+                                             : Limits::max();
+            // bounds beyond the range of T clip nothing
+            ClipOp<T> clip{
+                minValue && *minValue > float(lowest) ? T(*minValue) : lowest,
+                maxValue && *maxValue < float(highest) ? T(*maxValue)
+                                                       : highest};
+
             auto n = op->getOutput()->size();
-            for (size_t offset = 0; offset < n; offset++)
-            {
-                auto val = *inptr++;
-                *outptr++ = (minValue && val < *minValue)   ? *minValue
-                            : (maxValue && val > *maxValue) ? *maxValue
-                                                            : val;
-            }
+            parallelFor(context, n, PARALLEL_GRAIN,
+                        [&](size_t begin, size_t end)
+                        {
+                            vectorizedUnary(inptr + begin, outptr + begin,
+                                            end - begin, clip);
+                        });
         }
 
         void compute(const Operator &_op,
                      const RuntimeObj *context) const override
         {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
-            {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
-            }
+            dispatchDType(_op->getDType(), ArithmeticDTypes(),
+                          [&](auto tag)
+                          {
+                              using T = typename decltype(tag)::type;
+                              doCompute<T>(_op, context);
+                          });
         }
+
+        bool supportInplace() const override { return true; }
     };
 
     REGISTER_KERNEL(Device::CPU, OpType::Relu, NativeUnary, "reluNaive_CPU");
@@ -5,20 +5,42 @@ namespace infini
 {
 
     MatmulObj::MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, bool transA,
-                         bool transB)
-        : OperatorObj(OpType::MatMul, TensorVec{A, B}, {C}),
+                         bool transB, Tensor bias)
+        : OperatorObj(OpType::MatMul,
+                      bias ? TensorVec{A, B, bias} : TensorVec{A, B}, {C}),
           transA(transA), transB(transB)
     {
         IT_ASSERT(checkValid(graph));
     }
 
+    MatmulObj::MatmulObj(GraphObj *graph, Tensor A, TensorVec Bs,
+                         TensorVec outputs, bool transA, bool transB)
+        : OperatorObj(OpType::MatMul, {A}, std::move(outputs)), transA(transA),
+          transB(transB)
+    {
+        IT_ASSERT(!Bs.empty() && Bs.size() == this->outputs.size());
+        inputs.insert(inputs.end(), Bs.begin(), Bs.end());
+        IT_ASSERT(checkValid(graph));
+    }
+
     string MatmulObj::toString() const
     {
         std::ostringstream os;
         os << "Matmul([" << (transA ? "A^T" : "A") << "," << (transB ? "B^T" : "B]")
            << ",A=" << inputs[0]->getGuid()
-           << ",B=" << inputs[1]->getGuid() << ",C=" << outputs[0]->getGuid()
-           << ",mnk=[" << m << "," << n << "," << k << "])";
+           << ",B=" << inputs[1]->getGuid();
+        for (size_t i = 1; i < numWeights(); ++i)
+            os << "|" << inputs[1 + i]->getGuid();
+        os << ",C=" << outputs[0]->getGuid();
+        for (size_t i = 1; i < outputs.size(); ++i)
+            os << "|" << outputs[i]->getGuid();
+        os << ",mnk=[" << m << "," << n << "," << k << "]";
+        if (hasBias())
+            os << ",bias=" << inputs[2]->getGuid();
+        if (clipMin || clipMax)
+            os << ",clip=[" << (clipMin ? std::to_string(*clipMin) : "-inf")
+               << "," << (clipMax ? std::to_string(*clipMax) : "inf") << "]";
+        os << ")";
         return os.str();
     }
 
@@ -45,7 +67,37 @@ namespace infini
             result.at(result.size() - 1) = B->getDims().at(B->getDims().size() - 1);
         }
 
-        return {{result}};
+        if (outputs.size() == 1 && inputs.size() > 2)
+        {
+            // the bias is broadcast to C, never C to the bias
+            const auto &bias = inputs[2]->getDims();
+            if (bias.size() > result.size() ||
+                inputs[2]->getDType() != A->getDType())
+                return std::nullopt;
+            for (size_t i = 0; i < bias.size(); ++i)
+            {
+                auto dim = bias[bias.size() - 1 - i];
+                if (dim != 1 && dim != result[result.size() - 1 - i])
+                    return std::nullopt;
+            }
+        }
+
+        if (outputs.size() < 2)
+            return {{result}};
+        // the other Bs give the other outputs, with their own columns
+        vector<Shape> ans{result};
+        for (size_t i = 1; i < outputs.size(); ++i)
+        {
+            auto dims = inputs.at(1 + i)->getDims();
+            auto otherDims = B->getDims();
+            int cols = transB ? dims.size() - 2 : dims.size() - 1;
+            otherDims[cols] = dims[cols];
+            if (dims != otherDims || inputs[1 + i]->getDType() != B->getDType())
+                return std::nullopt;
+            ans.push_back(result);
+            ans.back().back() = dims[cols];
+        }
+        return ans;
     }
 
 } // namespace infini
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "operators/quantize_linear.h"
+
+namespace infini
+{
+
+    bool QuantParams::isValid() const
+    {
+        if (scales.empty() || scales.size() != zeroPoints.size())
+            return false;
+        for (size_t i = 0; i < scales.size(); ++i)
+        {
+            if (!(scales[i] > 0) || zeroPoints[i] < -128 || zeroPoints[i] > 127)
+                return false;
+        }
+        return true;
+    }
+
+    std::string QuantParams::toString() const
+    {
+        std::ostringstream os;
+        os << "scales=" << vecToString(scales)
+           << ",zeroPoints=" << vecToString(zeroPoints);
+        return os.str();
+    }
+
+    QuantizeLinearObj::QuantizeLinearObj(GraphObj *graph, Tensor input,
+                                         Tensor output, QuantParams quant)
+        : OperatorObj(OpType::QuantizeLinear, {input}, {output}),
+          quant(std::move(quant))
+    {
+        IT_ASSERT(checkValid(graph));
+    }
+
+    std::string QuantizeLinearObj::toString() const
+    {
+        std::ostringstream os;
+        os << type.toString() << "[" << getGuid() << "]";
+        os << "(";
+        os << vecToString(inputs[0]->getDims()) << ",";
+        os << "input=" << inputs[0]->getGuid() << ",";
+        os << "output=" << outputs[0]->getGuid() << ",";
+        os << quant.toString() << ")";
+        return os.str();
+    }
+
+    optional<vector<Shape>> QuantizeLinearObj::inferShape(const TensorVec &inputs)
+    {
+        if (inputs[0]->getDType() != DataType::Float32 || !quant.isValid() ||
+            quant.size() != 1)
+            return std::nullopt;
+        return {{inputs[0]->getDims()}};
+    }
+
+    vector<DataType> QuantizeLinearObj::inferDataType(const TensorVec &inputs) const
+    {
+        return {DataType::Int8};
+    }
+
+} // namespace infini
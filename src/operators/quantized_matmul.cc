@@ -0,0 +1,71 @@
+#include "operators/quantized_matmul.h"
+#include "utils/operator_utils.h"
+#include <algorithm>
+
+namespace infini
+{
+
+    QuantizedMatmulObj::QuantizedMatmulObj(GraphObj *graph, Tensor A, Tensor B,
+                                           Tensor C, QuantParams aQuant,
+                                           QuantParams bQuant,
+                                           optional<QuantParams> cQuant,
+                                           bool transA, bool transB)
+        : OperatorObj(OpType::QuantizedMatMul, TensorVec{A, B}, {C}),
+          transA(transA), transB(transB), aQuant(std::move(aQuant)),
+          bQuant(std::move(bQuant)), cQuant(std::move(cQuant))
+    {
+        IT_ASSERT(checkValid(graph));
+    }
+
+    string QuantizedMatmulObj::toString() const
+    {
+        std::ostringstream os;
+        os << "QuantizedMatmul([" << (transA ? "A^T" : "A") << ","
+           << (transB ? "B^T" : "B") << "],A=" << inputs[0]->getGuid()
+           << ",B=" << inputs[1]->getGuid() << ",C=" << outputs[0]->getGuid()
+           << ",A:" << aQuant.toString() << ",B:" << bQuant.toString();
+        if (cQuant)
+            os << ",C:" << cQuant->toString();
+        os << ")";
+        return os.str();
+    }
+
+    optional<vector<Shape>> QuantizedMatmulObj::inferShape(const TensorVec &inputs)
+    {
+        const auto &A = inputs[0], &B = inputs[1];
+        if (A->getDType() != DataType::Int8 || B->getDType() != DataType::Int8)
+            return std::nullopt;
+        const auto &aDims = A->getDims(), &bDims = B->getDims();
+        if (aDims.size() < 2 || bDims.size() < 2)
+            return std::nullopt;
+        int k = transA ? aDims[aDims.size() - 2] : aDims.back();
+        if (k != (transB ? bDims.back() : bDims[bDims.size() - 2]))
+            return std::nullopt;
+
+        Shape result = infer_broadcast(aDims, bDims);
+        result[result.size() - 2] =
+            transA ? aDims.back() : aDims[aDims.size() - 2];
+        result.back() = transB ? bDims[bDims.size() - 2] : bDims.back();
+
+        // A and C are quantized per tensor, B per tensor or per column of C
+        if (!aQuant.isValid() || aQuant.size() != 1 || !bQuant.isValid() ||
+            (bQuant.size() != 1 && int(bQuant.size()) != result.back()) ||
+            (cQuant && (!cQuant->isValid() || cQuant->size() != 1)))
+            return std::nullopt;
+        return {{result}};
+    }
+
+    vector<DataType> QuantizedMatmulObj::inferDataType(const TensorVec &inputs) const
+    {
+        return {cQuant ? DataType::Int8 : DataType::Float32};
+    }
+
+    size_t QuantizedMatmulObj::maxK(const QuantParams &bQuant)
+    {
+        bool symmetric = std::all_of(bQuant.zeroPoints.begin(),
+                                     bQuant.zeroPoints.end(),
+                                     [](int zero) { return zero == 0; });
+        return symmetric ? 65536 : 33025;
+    }
+
+} // namespace infini
@@ -12,7 +12,7 @@ namespace infini
         {
             for (size_t i = 0; i < rank; ++i)
             {
-                transposePermute[i] = i;
+                transposePermute.push_back(i);
             }
         }
         else
@@ -47,6 +47,36 @@ namespace infini
         return vector<Shape>{output_dim};
     }
 
+    void TransposeObj::setPermute(vector<int> permute)
+    {
+        auto dims = inputs[0]->getDims();
+        IT_ASSERT(permute.size() == dims.size());
+        for (size_t i = 0; i < dims.size(); ++i)
+        {
+            IT_ASSERT(dims[permute[i]] == outputs[0]->getDims()[i]);
+        }
+        transposePermute = std::move(permute);
+    }
+
+    bool TransposeObj::isRelabel() const
+    {
+        auto dims = inputs[0]->getDims();
+        int last = -1;
+        for (auto d : transposePermute)
+        {
+            if (dims[d] == 1)
+            {
+                continue;
+            }
+            if (d < last)
+            {
+                return false;
+            }
+            last = d;
+        }
+        return true;
+    }
+
     std::string TransposeObj::toString() const
     {
         std::ostringstream os;
@@ -0,0 +1,166 @@
+#include "utils/half.h"
+#include "utils/simd.h"
+
+namespace infini {
+
+namespace {
+
+template <typename Src, typename Dst>
+void convertScalar(const Src *src, Dst *dst, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = Dst(src[i]);
+}
+
+#if IT_X86
+// GCC 12 warns about the _mm512_undefined_* placeholders inside the AVX-512
+// conversion intrinsics.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+// Every vector loop converts the tail with the scalar conversion.
+#define CONVERT_VECTOR_LOOP(WIDTH, BODY)                                       \
+    size_t i = 0;                                                              \
+    for (; i + WIDTH <= n; i += WIDTH) {                                       \
+        BODY;                                                                  \
+    }                                                                          \
+    convertScalar(src + i, dst + i, n - i);
+
+IT_TARGET_AVX2 void floatToHalfAvx2(const float *src, float16_t *dst,
+                                    size_t n) {
+    CONVERT_VECTOR_LOOP(8, _mm_storeu_si128(
+                               (__m128i *)(dst + i),
+                               _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                               _MM_FROUND_TO_NEAREST_INT |
+                                                   _MM_FROUND_NO_EXC)))
+}
+
+IT_TARGET_AVX512 void floatToHalfAvx512(const float *src, float16_t *dst,
+                                        size_t n) {
+    CONVERT_VECTOR_LOOP(16, _mm256_storeu_si256(
+                                (__m256i *)(dst + i),
+                                _mm512_cvtps_ph(_mm512_loadu_ps(src + i),
+                                                _MM_FROUND_TO_NEAREST_INT |
+                                                    _MM_FROUND_NO_EXC)))
+}
+
+IT_TARGET_AVX2 void halfToFloatAvx2(const float16_t *src, float *dst,
+                                    size_t n) {
+    CONVERT_VECTOR_LOOP(8, _mm256_storeu_ps(dst + i,
+                                            _mm256_cvtph_ps(_mm_loadu_si128(
+                                                (const __m128i *)(src + i)))))
+}
+
+IT_TARGET_AVX512 void halfToFloatAvx512(const float16_t *src, float *dst,
+                                        size_t n) {
+    CONVERT_VECTOR_LOOP(16, _mm512_storeu_ps(dst + i,
+                                             _mm512_cvtph_ps(_mm256_loadu_si256(
+                                                 (const __m256i *)(src + i)))))
+}
+
+// Rounds to nearest even in the integer domain, exactly like
+// floatToBFloat16. NaNs are quieted.
+IT_TARGET_AVX2 inline __m256i roundToBFloat16Avx2(__m256 x) {
+    __m256i u = _mm256_castps_si256(x);
+    __m256i odd = _mm256_and_si256(_mm256_srli_epi32(u, 16),
+                                   _mm256_set1_epi32(1));
+    __m256i rounded = _mm256_srli_epi32(
+        _mm256_add_epi32(_mm256_add_epi32(u, _mm256_set1_epi32(0x7fff)), odd),
+        16);
+    __m256i nan = _mm256_or_si256(_mm256_srli_epi32(u, 16),
+                                  _mm256_set1_epi32(0x40));
+    __m256i isNan = _mm256_castps_si256(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+    return _mm256_blendv_epi8(rounded, nan, isNan);
+}
+
+IT_TARGET_AVX2 void floatToBFloat16Avx2(const float *src, bfloat16_t *dst,
+                                        size_t n) {
+    CONVERT_VECTOR_LOOP(
+        16, __m256i lo = roundToBFloat16Avx2(_mm256_loadu_ps(src + i));
+        __m256i hi = roundToBFloat16Avx2(_mm256_loadu_ps(src + i + 8));
+        // packus interleaves the 128-bit lanes of its operands
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi),
+                                                     0xd8)))
+}
+
+// vcvtneps2bf16 would do this in one instruction, but it flushes subnormals
+// to zero, so it would not match the scalar conversion.
+IT_TARGET_AVX512 void floatToBFloat16Avx512(const float *src, bfloat16_t *dst,
+                                            size_t n) {
+    CONVERT_VECTOR_LOOP(
+        16, __m512 x = _mm512_loadu_ps(src + i);
+        __m512i u = _mm512_castps_si512(x);
+        __m512i odd = _mm512_and_si512(_mm512_srli_epi32(u, 16),
+                                       _mm512_set1_epi32(1));
+        __m512i rounded = _mm512_srli_epi32(
+            _mm512_add_epi32(_mm512_add_epi32(u, _mm512_set1_epi32(0x7fff)),
+                             odd),
+            16);
+        __m512i nan = _mm512_or_si512(_mm512_srli_epi32(u, 16),
+                                      _mm512_set1_epi32(0x40));
+        __mmask16 isNan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+        _mm256_storeu_si256(
+            (__m256i *)(dst + i),
+            _mm512_cvtepi32_epi16(_mm512_mask_mov_epi32(rounded, isNan, nan))))
+}
+
+IT_TARGET_AVX2 void bfloat16ToFloatAvx2(const bfloat16_t *src, float *dst,
+                                        size_t n) {
+    CONVERT_VECTOR_LOOP(8, _mm256_storeu_si256(
+                               (__m256i *)(dst + i),
+                               _mm256_slli_epi32(
+                                   _mm256_cvtepu16_epi32(_mm_loadu_si128(
+                                       (const __m128i *)(src + i))),
+                                   16)))
+}
+
+IT_TARGET_AVX512 void bfloat16ToFloatAvx512(const bfloat16_t *src, float *dst,
+                                            size_t n) {
+    CONVERT_VECTOR_LOOP(16, _mm512_storeu_si512(
+                                dst + i, _mm512_slli_epi32(
+                                             _mm512_cvtepu16_epi32(
+                                                 _mm256_loadu_si256(
+                                                     (const __m256i *)(src + i))),
+                                             16)))
+}
+
+#undef CONVERT_VECTOR_LOOP
+#pragma GCC diagnostic pop
+
+#define SELECT(AVX2, AVX512, ...)                                              \
+    switch (cpuIsa()) {                                                        \
+    case CpuIsa::Avx512:                                                       \
+        return AVX512(__VA_ARGS__);                                            \
+    case CpuIsa::Avx2:                                                         \
+        return AVX2(__VA_ARGS__);                                              \
+    default:                                                                   \
+        break;                                                                 \
+    }
+#else
+#define SELECT(AVX2, AVX512, ...)
+#endif
+
+} // namespace
+
+void convertToFloat(const float16_t *src, float *dst, size_t n) {
+    SELECT(halfToFloatAvx2, halfToFloatAvx512, src, dst, n)
+    convertScalar(src, dst, n);
+}
+
+void convertToFloat(const bfloat16_t *src, float *dst, size_t n) {
+    SELECT(bfloat16ToFloatAvx2, bfloat16ToFloatAvx512, src, dst, n)
+    convertScalar(src, dst, n);
+}
+
+void convertFromFloat(const float *src, float16_t *dst, size_t n) {
+    SELECT(floatToHalfAvx2, floatToHalfAvx512, src, dst, n)
+    convertScalar(src, dst, n);
+}
+
+void convertFromFloat(const float *src, bfloat16_t *dst, size_t n) {
+    SELECT(floatToBFloat16Avx2, floatToBFloat16Avx512, src, dst, n)
+    convertScalar(src, dst, n);
+}
+
+#undef SELECT
+
+} // namespace infini
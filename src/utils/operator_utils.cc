@@ -76,6 +76,63 @@ size_t delocate_index(const Shape &shapeIndex, const Shape &shape,
     return ans;
 }
 
+BroadcastInfo analyze_broadcast(const Shape &A, const Shape &B,
+                                const Shape &C) {
+    size_t rank = C.size();
+    IT_ASSERT(A.size() <= rank && B.size() <= rank);
+    BroadcastInfo info;
+    vector<bool> broadcastA, broadcastB;
+    for (size_t i = 0; i < rank; ++i) {
+        if (C[i] == 1)
+            continue;
+        // A and B are aligned to C from the back
+        bool a = i + A.size() < rank || A[i + A.size() - rank] == 1;
+        bool b = i + B.size() < rank || B[i + B.size() - rank] == 1;
+        if (!info.dims.empty() && broadcastA.back() == a &&
+            broadcastB.back() == b) {
+            info.dims.back() *= C[i];
+        } else {
+            info.dims.push_back(C[i]);
+            broadcastA.push_back(a);
+            broadcastB.push_back(b);
+        }
+    }
+
+    size_t n = info.dims.size();
+    auto getStride = [&](const vector<bool> &broadcast) {
+        vector<size_t> stride(n);
+        size_t p = 1;
+        for (size_t i = n; i > 0; --i) {
+            stride[i - 1] = broadcast[i - 1] ? 0 : p;
+            if (!broadcast[i - 1])
+                p *= info.dims[i - 1];
+        }
+        return stride;
+    };
+    info.strideA = getStride(broadcastA);
+    info.strideB = getStride(broadcastB);
+
+    auto all = [](const vector<bool> &v, bool x) {
+        return std::all_of(v.begin(), v.end(), [x](bool y) { return y == x; });
+    };
+    if (all(broadcastA, false) && all(broadcastB, false))
+        info.kind = BroadcastInfo::Same;
+    else if (all(broadcastA, true))
+        info.kind = BroadcastInfo::ScalarA;
+    else if (all(broadcastB, true))
+        info.kind = BroadcastInfo::ScalarB;
+    else if (n == 2 && all(broadcastB, false))
+        // A differs between the two dims, or they would have been merged
+        info.kind =
+            broadcastA[0] ? BroadcastInfo::RowA : BroadcastInfo::ColumnA;
+    else if (n == 2 && all(broadcastA, false))
+        info.kind =
+            broadcastB[0] ? BroadcastInfo::RowB : BroadcastInfo::ColumnB;
+    else
+        info.kind = BroadcastInfo::General;
+    return info;
+}
+
 std::string device_to_str(Device device) {
     std::string deviceStr;
     switch (device) {
@@ -86,6 +143,30 @@ std::string device_to_str(Device device) {
     }
 }
 
+vector<size_t> matmul_batch_offsets(const Shape &dims, const Shape &cDims) {
+    size_t batchRank = cDims.size() - 2;
+    size_t matrixSize = dims[dims.size() - 2] * dims[dims.size() - 1];
+    // strides of the batch dimensions aligned to the right, 0 when broadcast
+    vector<size_t> strides(batchRank, 0);
+    size_t stride = matrixSize;
+    for (size_t i = 0; i + 2 < dims.size(); ++i) {
+        size_t dim = dims.size() - 3 - i, cDim = batchRank - 1 - i;
+        strides[cDim] = dims[dim] == 1 ? 0 : stride;
+        stride *= dims[dim];
+    }
+    size_t batch = 1;
+    for (size_t i = 0; i < batchRank; ++i)
+        batch *= cDims[i];
+    vector<size_t> offsets(batch, 0);
+    for (size_t b = 0; b < batch; ++b) {
+        for (size_t i = batchRank, rest = b; i > 0; --i) {
+            offsets[b] += rest % cDims[i - 1] * strides[i - 1];
+            rest /= cDims[i - 1];
+        }
+    }
+    return offsets;
+}
+
 std::string get_kernel_attrs_str(const KernelAttrs &kernelAttrs) {
     std::string deviceStr = device_to_str(std::get<0>(kernelAttrs));
     std::string opStr = OpType(std::get<1>(kernelAttrs)).toString();
@@ -2,6 +2,8 @@
 #include "core/kernel.h"
 #include "core/runtime.h"
 #include "operators/unary.h"
+#include <chrono>
+#include <random>
 
 #include "test.h"
 
@@ -71,4 +73,67 @@ namespace infini
         EXPECT_EQ(ptr1, ptr2);
     }
 
+    TEST(Allocator, testAlignment)
+    {
+        Runtime runtime = make_ref<NativeCpuRuntimeObj>(128);
+        Allocator allocator = Allocator(runtime);
+        size_t offsetA = allocator.alloc(1);
+        size_t offsetB = allocator.alloc(130);
+        size_t offsetC = allocator.alloc(4);
+        EXPECT_EQ(offsetA, 0u);
+        EXPECT_EQ(offsetB, 128u);
+        EXPECT_EQ(offsetC, 384u);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(allocator.getPtr()) % 128, 0u);
+    }
+
+    TEST(Allocator, testFreeMerge)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Allocator allocator = Allocator(runtime);
+        size_t offsetA = allocator.alloc(64);
+        size_t offsetB = allocator.alloc(64);
+        size_t offsetC = allocator.alloc(64);
+        allocator.alloc(64);
+        // a and c are not adjacent, b joins them into one block
+        allocator.free(offsetA, 64);
+        allocator.free(offsetC, 64);
+        allocator.free(offsetB, 64);
+        EXPECT_EQ(allocator.alloc(192), offsetA);
+    }
+
+    TEST(Allocator, testStress)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Allocator allocator = Allocator(runtime);
+        std::mt19937 gen(0);
+        std::uniform_int_distribution<size_t> sizeDist(1, 1 << 16);
+        const size_t pairs = 100000, window = 4096;
+        vector<pair<size_t, size_t>> live;
+        live.reserve(window);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < pairs; ++i)
+        {
+            size_t size = sizeDist(gen);
+            live.emplace_back(allocator.alloc(size), size);
+            if (live.size() == window)
+            {
+                // free a random live block to fragment the free list
+                std::swap(live[gen() % window], live.back());
+                allocator.free(live.back().first, live.back().second);
+                live.pop_back();
+            }
+        }
+        for (auto &[addr, size] : live)
+            allocator.free(addr, size);
+        auto elapsed = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+        std::cout << "Planned " << pairs << " alloc/free pairs in " << elapsed
+                  << " ms" << std::endl;
+        allocator.info();
+        // every block is merged back into the memory bank
+        EXPECT_EQ(allocator.alloc(1), 0u);
+    }
+
 } // namespace infini
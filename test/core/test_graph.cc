@@ -1,13 +1,55 @@
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
 #include "operators/matmul.h"
 #include "operators/transpose.h"
+#include "operators/unary.h"
 
 #include "test.h"
 
 namespace infini
 {
+    // A graph with its inputs and outputs
+    struct TestGraph
+    {
+        Graph g;
+        TensorVec inputs, outputs;
+    };
+
+    /**
+     * @brief Builds a graph twice with 'build', which returns its inputs and
+     * outputs, optimizes one of them, and checks that both compute the same
+     * outputs from the same inputs. Returns the optimized graph, so that the
+     * caller can check its structure.
+     */
+    static TestGraph expectSameOutputs(
+        const std::function<pair<TensorVec, TensorVec>(Graph)> &build)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph ref = make_ref<GraphObj>(runtime);
+        Graph g = make_ref<GraphObj>(runtime);
+        auto [refInputs, refOutputs] = build(ref);
+        auto [inputs, outputs] = build(g);
+        g->optimize();
+
+        ref->dataMalloc();
+        g->dataMalloc();
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            refInputs[i]->setData(IncrementalGenerator());
+            inputs[i]->setData(IncrementalGenerator());
+        }
+        runtime->run(ref);
+        runtime->run(g);
+        for (size_t i = 0; i < outputs.size(); ++i)
+        {
+            EXPECT_TRUE(outputs[i]->equalData(refOutputs[i]));
+        }
+        return {g, inputs, outputs};
+    }
+
     TEST(Graph, Optimize)
     {
         Runtime runtime = NativeCpuRuntimeObj::getInstance();
@@ -37,4 +79,610 @@ namespace infini
         EXPECT_EQ(op->getTransA(), false);
         EXPECT_EQ(op->getTransB(), true);
     }
-}
\ No newline at end of file
+
+    TEST(Graph, TopoSortMultipleOutputs)
+    {
+        // an Add of both outputs of one MatMul, added before the MatMul
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({2, 3}, DataType::Float32);
+        auto w0 = g->addTensor({3, 4}, DataType::Float32);
+        auto w1 = g->addTensor({3, 4}, DataType::Float32);
+        auto c0 = g->addTensor({2, 4}, DataType::Float32);
+        auto c1 = g->addTensor({2, 4}, DataType::Float32);
+        auto o = g->addTensor({2, 4}, DataType::Float32);
+        auto add = g->addOpWithOutputs<AddObj>(c0, c1, o);
+        auto matmul = g->addOpWithOutputs<MatmulObj>(x, TensorVec{w0, w1},
+                                                      TensorVec{c0, c1});
+        EXPECT_TRUE(g->topo_sort());
+        EXPECT_EQ(g->getOperators(), (OpVec{matmul, add}));
+    }
+
+    TEST(Graph, OptimizeSharedTranspose)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({3, 4}, DataType::Float32);
+        Tensor w = g->addTensor({3, 5}, DataType::Float32);
+        auto t = g->addOp<TransposeObj>(i, nullptr, Shape{1, 0})->getOutput();
+        auto matmul = g->addOp<MatmulObj>(t, w, nullptr);
+        g->addOp<ReluObj>(t, nullptr);
+        g->optimize();
+        // the transpose is folded into the MatMul, and kept for the Relu
+        // but moved below it
+        EXPECT_EQ(g->getOperators().size(), 3u);
+        EXPECT_EQ(matmul->getInputs(0), i);
+        EXPECT_TRUE(matmul->getTransA());
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeKeepsUnreadInputs)
+    {
+        // a is never read, and b goes through two transposes that cancel
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto a = g->addTensor({2, 3}, DataType::Float32);
+        auto b = g->addTensor({2, 3}, DataType::Float32);
+        auto t = g->addOp<TransposeObj>(b, nullptr, Shape{1, 0})->getOutput();
+        g->addOp<TransposeObj>(t, nullptr, Shape{1, 0});
+        g->optimize();
+
+        EXPECT_EQ(g->getInputs(), (TensorVec{a, b}));
+        g->dataMalloc();
+        // asserts that a has memory
+        a->setData(IncrementalGenerator());
+    }
+
+    TEST(Graph, OptimizeTransposeChains)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i0 = g->addTensor({2, 3, 4, 5}, DataType::Float32);
+        Tensor i1 = g->addTensor({2, 3, 4}, DataType::Float32);
+        Tensor i2 = g->addTensor({1, 1, 6}, DataType::Float32);
+        // inverse permutations that are not self-inverse
+        auto t = g->addOp<TransposeObj>(i0, nullptr, Shape{0, 2, 3, 1});
+        t = g->addOp<TransposeObj>(t->getOutput(), nullptr, Shape{0, 3, 1, 2});
+        auto relu0 = g->addOp<ReluObj>(t->getOutput(), nullptr);
+        // a chain ending at a graph output becomes one transpose
+        t = g->addOp<TransposeObj>(i1, nullptr, Shape{1, 2, 0});
+        t = g->addOp<TransposeObj>(t->getOutput(), nullptr, Shape{1, 2, 0});
+        t = g->addOp<TransposeObj>(t->getOutput(), nullptr, Shape{0, 2, 1});
+        auto o1 = t->getOutput();
+        // swapping size-1 dims keeps the data and the shape
+        t = g->addOp<TransposeObj>(i2, nullptr, Shape{1, 0, 2});
+        auto relu2 = g->addOp<ReluObj>(t->getOutput(), nullptr);
+        g->optimize();
+
+        EXPECT_EQ(g->getOperators().size(), 3u);
+        EXPECT_EQ(relu0->getInputs(0), i0);
+        EXPECT_EQ(relu2->getInputs(0), i2);
+        auto last = as<TransposeObj>(o1->getSource());
+        EXPECT_EQ(last->getInputs(0), i1);
+        // (1, 2, 0) twice is (2, 0, 1), then the last two dims are swapped
+        EXPECT_EQ(last->getPermute(), (vector<int>{2, 1, 0}));
+        EXPECT_EQ(o1->getDims(), (Shape{4, 3, 2}));
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeSinkTransposes)
+    {
+        // Transpose -> Relu -> Clip -> Add(Transpose) -> Mul(bias) ->
+        // Transpose^-1, and Transpose -> Relu -> MatMul
+        auto build = [](Graph g)
+        {
+            auto x = g->addTensor({2, 3, 4}, DataType::Float32);
+            auto y = g->addTensor({2, 3, 4}, DataType::Float32);
+            auto bias = g->addTensor({1, 1, 3}, DataType::Float32);
+            auto w = g->addTensor({3, 5}, DataType::Float32);
+            auto t = g->addOp<TransposeObj>(x, nullptr, Shape{0, 2, 1});
+            auto r = g->addOp<ReluObj>(t->getOutput(), nullptr);
+            auto c = g->addOp<ClipObj>(r->getOutput(), nullptr, 1.0f, 20.0f);
+            auto ty = g->addOp<TransposeObj>(y, nullptr, Shape{0, 2, 1});
+            auto a = g->addOp<AddObj>(c->getOutput(), ty->getOutput(), nullptr);
+            auto m = g->addOp<MulObj>(a->getOutput(), bias, nullptr);
+            auto o0 = g->addOp<TransposeObj>(m->getOutput(), nullptr,
+                                             Shape{0, 2, 1})
+                          ->getOutput();
+            auto t1 = g->addOp<TransposeObj>(x, nullptr, Shape{0, 2, 1});
+            auto r1 = g->addOp<ReluObj>(t1->getOutput(), nullptr);
+            auto o1 = g->addOp<MatmulObj>(r1->getOutput(), w, nullptr)
+                          ->getOutput();
+            return pair{TensorVec{x, y, bias, w}, TensorVec{o0, o1}};
+        };
+        auto [g, inputs, outputs] = expectSameOutputs(build);
+
+        // only the bias is transposed, to (1, 3, 1)
+        size_t transposes = 0;
+        for (auto &op : g->getOperators())
+        {
+            if (op->getOpType() == OpType::Transpose)
+            {
+                ++transposes;
+                EXPECT_EQ(op->getOutput()->getDims(), (Shape{1, 3, 1}));
+            }
+        }
+        EXPECT_EQ(transposes, 1u);
+        // the Relu and the Clip are composed into one Clip
+        EXPECT_EQ(g->getOperators().size(), 6u);
+        auto matmul = as<MatmulObj>(outputs[1]->getSource());
+        EXPECT_TRUE(matmul->getTransA());
+        EXPECT_EQ(outputs[0]->getDims(), (Shape{2, 3, 4}));
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeMatmulEpilogue)
+    {
+        // MatMul -> Add(bias) -> Relu, MatMul -> Clip -> Clip, and a MatMul
+        // whose output is also read by another operator. They read different
+        // As, so that they are not fused with each other.
+        auto build = [](Graph g)
+        {
+            auto x = g->addTensor({2, 5, 8}, DataType::Float32);
+            auto y = g->addTensor({2, 5, 8}, DataType::Float32);
+            auto w = g->addTensor({8, 6}, DataType::Float32);
+            auto bias = g->addTensor({6}, DataType::Float32);
+            auto mm = g->addOp<MatmulObj>(x, w, nullptr)->getOutput();
+            auto add = g->addOp<AddObj>(bias, mm, nullptr)->getOutput();
+            auto o0 = g->addOp<ReluObj>(add, nullptr)->getOutput();
+            mm = g->addOp<MatmulObj>(y, w, nullptr)->getOutput();
+            auto clip = g->addOp<ClipObj>(mm, nullptr, -100.f, 50.f);
+            auto o1 = g->addOp<ClipObj>(clip->getOutput(), nullptr, 0.f,
+                                        std::nullopt)
+                          ->getOutput();
+            mm = g->addOp<MatmulObj>(w, x, nullptr, true, true)->getOutput();
+            auto o2 = g->addOp<ReluObj>(mm, nullptr)->getOutput();
+            auto o3 = g->addOp<AddObj>(mm, mm, nullptr)->getOutput();
+            return pair{TensorVec{x, y, w, bias}, TensorVec{o0, o1, o2, o3}};
+        };
+        auto [g, inputs, outputs] = expectSameOutputs(build);
+
+        EXPECT_EQ(g->getOperators().size(), 5u);
+        auto fused = as<MatmulObj>(outputs[0]->getSource());
+        ASSERT_EQ(fused->getOpType(), OpType::MatMul);
+        EXPECT_TRUE(fused->hasBias());
+        EXPECT_EQ(fused->getClipMin(), 0.f);
+        EXPECT_EQ(fused->getClipMax(), std::nullopt);
+        fused = as<MatmulObj>(outputs[1]->getSource());
+        ASSERT_EQ(fused->getOpType(), OpType::MatMul);
+        EXPECT_FALSE(fused->hasBias());
+        EXPECT_EQ(fused->getClipMin(), 0.f);
+        EXPECT_EQ(fused->getClipMax(), 50.f);
+        EXPECT_EQ(outputs[2]->getSource()->getOpType(), OpType::Relu);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeAlgebraic)
+    {
+        auto build = [](Graph g)
+        {
+            auto x = g->addTensor({2, 3}, DataType::Float32);
+            auto y = g->addTensor({2, 3}, DataType::Int32);
+            auto relu = g->addOp<ReluObj>(x, nullptr)->getOutput();
+            auto o0 = g->addOp<ReluObj>(relu, nullptr)->getOutput();
+            auto o1 = g->addOp<ClipObj>(x, nullptr, 0.f, std::nullopt)
+                          ->getOutput();
+            auto clip = g->addOp<ClipObj>(x, nullptr, std::nullopt,
+                                          INFINITY)
+                            ->getOutput();
+            auto o2 = g->addOp<ReluObj>(clip, nullptr)->getOutput();
+            clip = g->addOp<ClipObj>(x, nullptr, -5.f, 3.f)->getOutput();
+            auto o3 = g->addOp<ClipObj>(clip, nullptr, 1.f, 10.f)->getOutput();
+            auto cast = g->addOp<CastObj>(x, nullptr, CastType::Float2Float)
+                            ->getOutput();
+            auto o4 = g->addOp<AddObj>(cast, x, nullptr)->getOutput();
+            // a lossy round trip is kept
+            auto half = g->addOp<CastObj>(x, nullptr, CastType::Float2Float16)
+                            ->getOutput();
+            auto o5 = g->addOp<CastObj>(half, nullptr, CastType::Float162Float)
+                          ->getOutput();
+            cast = g->addOp<CastObj>(y, nullptr, CastType::Int322Int64)
+                       ->getOutput();
+            cast = g->addOp<CastObj>(cast, nullptr, CastType::Int642Int32)
+                       ->getOutput();
+            auto o6 = g->addOp<AddObj>(cast, y, nullptr)->getOutput();
+            return pair{TensorVec{x, y}, TensorVec{o0, o1, o2, o3, o4, o5, o6}};
+        };
+        auto [g, inputs, outputs] = expectSameOutputs(build);
+
+        EXPECT_EQ(g->getOperators().size(), 8u);
+        for (size_t i : {0, 1, 2})
+        {
+            auto op = outputs[i]->getSource();
+            EXPECT_EQ(op->getOpType(), OpType::Relu);
+            EXPECT_EQ(op->getInputs(0), inputs[0]);
+        }
+        auto clip = as<ClipObj>(outputs[3]->getSource());
+        ASSERT_EQ(clip->getOpType(), OpType::Clip);
+        EXPECT_EQ(clip->getInputs(0), inputs[0]);
+        EXPECT_EQ(clip->getMin(), 1.f);
+        EXPECT_EQ(clip->getMax(), 3.f);
+        EXPECT_EQ(outputs[4]->getSource()->getInputs(),
+                  (TensorVec{inputs[0], inputs[0]}));
+        EXPECT_EQ(outputs[5]->getSource()->getOpType(), OpType::Cast);
+        EXPECT_EQ(outputs[6]->getSource()->getInputs(),
+                  (TensorVec{inputs[1], inputs[1]}));
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeSignedZero)
+    {
+        // x + (+0) and x - (-0) turn -0 into +0, so they are kept, unlike
+        // x + (-0), x - (+0) and the addition of an integer 0
+        auto build = [](Graph g)
+        {
+            auto x = g->addTensor({2, 3}, DataType::Float32);
+            auto xi = g->addTensor({2, 3}, DataType::Int32);
+            auto zero = [&](DataType dtype, float value)
+            {
+                auto t = g->addTensor({2, 3}, dtype);
+                g->setConstant(t);
+                t->setData([=](void *ptr, size_t size, DataType)
+                           {
+                               for (size_t i = 0; i < size; ++i)
+                               {
+                                   if (dtype == DataType::Int32)
+                                       static_cast<int32_t *>(ptr)[i] = 0;
+                                   else
+                                       static_cast<float *>(ptr)[i] = value;
+                               }
+                           });
+                return t;
+            };
+            auto pos = zero(DataType::Float32, 0.f);
+            auto neg = zero(DataType::Float32, -0.f);
+            TensorVec sums{
+                g->addOp<AddObj>(x, pos, nullptr)->getOutput(),
+                g->addOp<AddObj>(neg, x, nullptr)->getOutput(),
+                g->addOp<SubObj>(x, neg, nullptr)->getOutput(),
+                g->addOp<SubObj>(x, pos, nullptr)->getOutput(),
+                g->addOp<AddObj>(xi, zero(DataType::Int32, 0.f), nullptr)
+                    ->getOutput()};
+            TensorVec outputs;
+            for (auto &sum : sums)
+                outputs.push_back(g->addOp<ReluObj>(sum, nullptr)->getOutput());
+            return pair{TensorVec{x, xi}, outputs};
+        };
+        auto [g, inputs, outputs] = expectSameOutputs(build);
+
+        EXPECT_EQ(g->getOperators().size(), 7u);
+        EXPECT_EQ(outputs[0]->getSource()->getInputs(0)->getSource()->getOpType(),
+                  OpType::Add);
+        EXPECT_EQ(outputs[1]->getSource()->getInputs(0), inputs[0]);
+        EXPECT_EQ(outputs[2]->getSource()->getInputs(0)->getSource()->getOpType(),
+                  OpType::Sub);
+        EXPECT_EQ(outputs[3]->getSource()->getInputs(0), inputs[0]);
+        EXPECT_EQ(outputs[4]->getSource()->getInputs(0), inputs[1]);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeConstantFolding)
+    {
+        // x * w^T + bias * scale - 0 and Relu(x / 1), with w, bias, scale, 0
+        // and 1 constants
+        auto build = [](Graph g)
+        {
+            auto x = g->addTensor({2, 3}, DataType::Float32);
+            auto w = g->addTensor({4, 3}, DataType::Float32);
+            auto bias = g->addTensor({2, 4}, DataType::Float32);
+            auto scale = g->addTensor({2, 4}, DataType::Float32);
+            auto zero = g->addTensor({2, 4}, DataType::Float32);
+            auto one = g->addTensor({2, 3}, DataType::Float32);
+            for (auto &tensor : {w, bias, scale})
+            {
+                g->setConstant(tensor);
+                tensor->setData(IncrementalGenerator());
+            }
+            g->setConstant(zero);
+            zero->setData(ValGenerator<0>());
+            g->setConstant(one);
+            one->setData(ValGenerator<1>());
+            auto t = g->addOp<TransposeObj>(w, nullptr, Shape{1, 0})->getOutput();
+            auto mm = g->addOp<MatmulObj>(x, t, nullptr)->getOutput();
+            auto b = g->addOp<MulObj>(bias, scale, nullptr)->getOutput();
+            auto y = g->addOp<AddObj>(mm, b, nullptr)->getOutput();
+            auto o0 = g->addOp<SubObj>(y, zero, nullptr)->getOutput();
+            auto div = g->addOp<DivObj>(x, one, nullptr)->getOutput();
+            auto o1 = g->addOp<ReluObj>(div, nullptr)->getOutput();
+            return pair{TensorVec{x}, TensorVec{o0, o1}};
+        };
+        auto [g, inputs, outputs] = expectSameOutputs(build);
+
+        EXPECT_EQ(g->getOperators().size(), 2u);
+        auto matmul = as<MatmulObj>(outputs[0]->getSource());
+        ASSERT_EQ(matmul->getOpType(), OpType::MatMul);
+        EXPECT_EQ(matmul->getInputs(0), inputs[0]);
+        EXPECT_TRUE(matmul->hasBias());
+        EXPECT_TRUE(matmul->getInputs(2)->isConstant());
+        auto relu = outputs[1]->getSource();
+        EXPECT_EQ(relu->getOpType(), OpType::Relu);
+        EXPECT_EQ(relu->getInputs(0), inputs[0]);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeConstantUnsupportedDType)
+    {
+        // x + 0 + (0 + 0) in int16, which the CPU kernels do not support, so
+        // the rules decline instead of halting
+        Graph g = make_ref<GraphObj>(NativeCpuRuntimeObj::getInstance());
+        auto x = g->addTensor({2, 3}, DataType::Int16);
+        TensorVec zeros;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto zero = g->addTensor({2, 3}, DataType::Int16);
+            g->setConstant(zero);
+            zero->setData([](void *ptr, size_t size, DataType)
+                          { std::fill_n(static_cast<int16_t *>(ptr), size, 0); });
+            zeros.push_back(zero);
+        }
+        auto y = g->addOp<AddObj>(x, zeros[0], nullptr)->getOutput();
+        auto sum = g->addOp<AddObj>(zeros[1], zeros[2], nullptr)->getOutput();
+        g->addOp<AddObj>(y, sum, nullptr);
+        g->optimize();
+
+        EXPECT_EQ(g->getOperators().size(), 3u);
+        EXPECT_EQ(g->getTensors().size(), 7u);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeMatmulChain)
+    {
+        // x * (a * b) with a low rank, u * v^T * w with a single column, and
+        // a chain whose intermediate product is also read by another MatMul
+        auto build = [](Graph g)
+        {
+            auto x = g->addTensor({2, 3, 4}, DataType::Float32);
+            auto a = g->addTensor({4, 2}, DataType::Float32);
+            auto b = g->addTensor({2, 5}, DataType::Float32);
+            auto u = g->addTensor({6, 2}, DataType::Float32);
+            auto v = g->addTensor({6, 2}, DataType::Float32);
+            auto w = g->addTensor({6, 1}, DataType::Float32);
+            auto ab = g->addOp<MatmulObj>(a, b, nullptr)->getOutput();
+            auto o0 = g->addOp<MatmulObj>(x, ab, nullptr)->getOutput();
+            auto uv = g->addOp<MatmulObj>(u, v, nullptr, false, true)
+                          ->getOutput();
+            auto o1 = g->addOp<MatmulObj>(uv, w, nullptr)->getOutput();
+            auto y = g->addTensor({2, 3, 4}, DataType::Float32);
+            auto ya = g->addOp<MatmulObj>(y, a, nullptr)->getOutput();
+            auto o2 = g->addOp<MatmulObj>(ya, b, nullptr)->getOutput();
+            auto o3 = g->addOp<MatmulObj>(ya, a, nullptr, false, true)
+                          ->getOutput();
+            return pair{TensorVec{x, a, b, u, v, w, y},
+                        TensorVec{o0, o1, o2, o3}};
+        };
+        auto [g, inputs, outputs] = expectSameOutputs(build);
+
+        // (x * a) * b
+        auto last = outputs[0]->getSource();
+        EXPECT_EQ(last->getInputs(1), inputs[2]);
+        auto first = last->getInputs(0)->getSource();
+        ASSERT_TRUE(first);
+        EXPECT_EQ(first->getInputs(), (TensorVec{inputs[0], inputs[1]}));
+        // u * (v^T * w), with v now the transposed A
+        last = outputs[1]->getSource();
+        EXPECT_EQ(last->getInputs(0), inputs[3]);
+        first = last->getInputs(1)->getSource();
+        ASSERT_TRUE(first);
+        EXPECT_EQ(first->getInputs(), (TensorVec{inputs[4], inputs[5]}));
+        EXPECT_TRUE(as<MatmulObj>(first)->getTransA());
+        // y * a is read twice, so it is kept
+        EXPECT_EQ(outputs[2]->getSource()->getInputs(1), inputs[2]);
+        EXPECT_EQ(g->getOperators().size(), 7u);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeSiblingMatmuls)
+    {
+        // three MatMuls of x, two of them with B transposed, and one whose B
+        // is computed
+        auto build = [](Graph g)
+        {
+            auto x = g->addTensor({2, 5, 8}, DataType::Float32);
+            auto w0 = g->addTensor({8, 6}, DataType::Float32);
+            auto w1 = g->addTensor({8, 3}, DataType::Float32);
+            auto v0 = g->addTensor({4, 8}, DataType::Float32);
+            auto v1 = g->addTensor({7, 8}, DataType::Float32);
+            auto o0 = g->addOp<MatmulObj>(x, w0, nullptr)->getOutput();
+            auto mm = g->addOp<MatmulObj>(x, w1, nullptr)->getOutput();
+            auto o1 = g->addOp<ReluObj>(mm, nullptr)->getOutput();
+            auto o2 = g->addOp<MatmulObj>(x, v0, nullptr, false, true)
+                          ->getOutput();
+            auto o3 = g->addOp<MatmulObj>(x, v1, nullptr, false, true)
+                          ->getOutput();
+            auto w2 = g->addOp<ReluObj>(w0, nullptr)->getOutput();
+            auto o4 = g->addOp<MatmulObj>(x, w2, nullptr)->getOutput();
+            return pair{TensorVec{x, w0, w1, v0, v1},
+                        TensorVec{o0, o1, o2, o3, o4}};
+        };
+        auto [g, inputs, outputs] = expectSameOutputs(build);
+
+        // the fused MatMuls, the Relus and the MatMul of the Relu
+        EXPECT_EQ(g->getOperators().size(), 5u);
+        auto fused = as<MatmulObj>(outputs[0]->getSource());
+        ASSERT_EQ(fused->getOpType(), OpType::MatMul);
+        EXPECT_EQ(fused->getInputs(), (TensorVec{inputs[0], inputs[1], inputs[2]}));
+        EXPECT_EQ(fused->getOutputs(),
+                  (TensorVec{outputs[0], outputs[1]->getSource()->getInputs(0)}));
+        fused = as<MatmulObj>(outputs[2]->getSource());
+        ASSERT_EQ(fused->getOpType(), OpType::MatMul);
+        EXPECT_EQ(fused->getInputs(), (TensorVec{inputs[0], inputs[3], inputs[4]}));
+        EXPECT_EQ(fused->getOutputs(), (TensorVec{outputs[2], outputs[3]}));
+        EXPECT_TRUE(fused->getTransB());
+        EXPECT_EQ(outputs[4]->getSource()->numOutputs(), 1);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeSiblingMatmulsAttention)
+    {
+        // softmax-free attention: q * k^T * v, with q, k and v MatMuls of x,
+        // so that the fused MatMul feeds the same reader twice
+        auto build = [](Graph g)
+        {
+            auto x = g->addTensor({2, 5, 8}, DataType::Float32);
+            auto wq = g->addTensor({8, 6}, DataType::Float32);
+            auto wk = g->addTensor({8, 6}, DataType::Float32);
+            auto wv = g->addTensor({8, 6}, DataType::Float32);
+            auto q = g->addOp<MatmulObj>(x, wq, nullptr)->getOutput();
+            auto k = g->addOp<MatmulObj>(x, wk, nullptr)->getOutput();
+            auto v = g->addOp<MatmulObj>(x, wv, nullptr)->getOutput();
+            auto s = g->addOp<MatmulObj>(q, k, nullptr, false, true)
+                         ->getOutput();
+            auto o = g->addOp<MatmulObj>(s, v, nullptr)->getOutput();
+            return pair{TensorVec{x, wq, wk, wv}, TensorVec{o}};
+        };
+        auto [g, inputs, outputs] = expectSameOutputs(build);
+
+        EXPECT_EQ(g->getOperators().size(), 3u);
+        auto o = outputs[0]->getSource();
+        auto s = o->getInputs(0)->getSource();
+        ASSERT_TRUE(s);
+        auto fused = s->getInputs(0)->getSource();
+        ASSERT_TRUE(fused);
+        EXPECT_EQ(fused->getInputs(),
+                  (TensorVec{inputs[0], inputs[1], inputs[2], inputs[3]}));
+        EXPECT_EQ(s->getInputs(1)->getSource(), fused);
+        EXPECT_EQ(o->getInputs(1)->getSource(), fused);
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, OptimizeLargeGraph)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({4, 8}, DataType::Float32);
+        Tensor w = g->addTensor({8, 4}, DataType::Float32);
+        Tensor t = i;
+        for (int n = 0; n < 50000; ++n)
+            t = g->addOp<TransposeObj>(t, nullptr, Shape{1, 0})->getOutput();
+        auto o = g->addOp<MatmulObj>(t, w, nullptr)->getOutput();
+        g->optimize();
+        ASSERT_EQ(g->getOperators().size(), 1u);
+        EXPECT_EQ(g->getTensors().size(), 3u);
+        auto op = g->getOperators()[0];
+        EXPECT_EQ(op->getInputs(0), i);
+        EXPECT_EQ(op->getOutput(), o);
+        EXPECT_FALSE(as<MatmulObj>(op)->getTransA());
+        EXPECT_TRUE(g->checkValid());
+    }
+
+    TEST(Graph, DataMallocReuse)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({2, 3, 4, 5}, DataType::Float32);
+        TensorVec chain{i};
+        for (int n = 0; n < 8; ++n)
+        {
+            chain.emplace_back(
+                g->addOp<ReluObj>(chain.back(), nullptr)->getOutput());
+        }
+        g->dataMalloc();
+        // intermediates die after their only target, so the arena only holds
+        // the pinned input and output plus two activations in flight
+        std::set<void *> blocks;
+        for (auto &t : chain)
+        {
+            blocks.insert(t->getRawDataPtr<void *>());
+        }
+        EXPECT_LE(blocks.size(), 4u);
+        EXPECT_NE(i->getRawDataPtr<void *>(),
+                  chain.back()->getRawDataPtr<void *>());
+
+        i->setData(IncrementalGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(chain.back()->equalData(i));
+    }
+
+    TEST(Graph, DataMallocInplace)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        for (bool inplace : {true, false})
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            Tensor i0 = g->addTensor({2, 3, 4}, DataType::Float32);
+            Tensor i1 = g->addTensor({4}, DataType::Float32);
+            auto add = g->addOp<AddObj>(i0, i1, nullptr);
+            auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+            auto clip =
+                g->addOp<ClipObj>(relu->getOutput(), nullptr, 1.0f, 20.0f);
+            g->dataMalloc(inplace);
+            // graph inputs are never overwritten
+            EXPECT_NE(add->getOutput()->getRawDataPtr<void *>(),
+                      i0->getRawDataPtr<void *>());
+            EXPECT_EQ(relu->getOutput()->getRawDataPtr<void *>() ==
+                          add->getOutput()->getRawDataPtr<void *>(),
+                      inplace);
+            EXPECT_EQ(clip->getOutput()->getRawDataPtr<void *>() ==
+                          relu->getOutput()->getRawDataPtr<void *>(),
+                      inplace);
+
+            i0->setData(IncrementalGenerator());
+            i1->setData(OneGenerator());
+            runtime->run(g);
+            vector<float> ans(24);
+            for (size_t j = 0; j < ans.size(); ++j)
+            {
+                ans[j] = std::min(j + 1.0f, 20.0f);
+            }
+            EXPECT_TRUE(clip->getOutput()->equalData(ans));
+        }
+    }
+
+    TEST(Graph, DataMallocRelabel)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({1, 1, 6}, DataType::Float32);
+        auto r = g->addOp<ReluObj>(i, nullptr)->getOutput();
+        // moves the size-1 dims only
+        auto t = g->addOp<TransposeObj>(r, nullptr, Shape{1, 0, 2})->getOutput();
+        auto clip = g->addOp<ClipObj>(t, nullptr, 0.0f, 2.0f)->getOutput();
+        auto add = g->addOp<AddObj>(r, clip, nullptr);
+        g->dataMalloc();
+        EXPECT_EQ(t->getRawDataPtr<void *>(), r->getRawDataPtr<void *>());
+        // r is read after the clip, so the clip cannot run in place on t
+        EXPECT_NE(clip->getRawDataPtr<void *>(), t->getRawDataPtr<void *>());
+
+        i->setData(IncrementalGenerator());
+        runtime->run(g);
+        EXPECT_TRUE(add->getOutput()->equalData(
+            vector<float>{0, 2, 4, 5, 6, 7}));
+    }
+
+    TEST(Graph, DataMallocZeroCopyConcat)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        // the inputs are contiguous slices of the output only for axis 0
+        for (int dim : {0, 1})
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            Tensor i0 = g->addTensor({4, 16}, DataType::Float32);
+            Tensor i1 = g->addTensor({4, 16}, DataType::Float32);
+            auto relu0 = g->addOp<ReluObj>(i0, nullptr);
+            auto relu1 = g->addOp<ReluObj>(i1, nullptr);
+            auto concat = g->addOp<ConcatObj>(
+                TensorVec{relu0->getOutput(), relu1->getOutput()}, nullptr,
+                dim);
+            g->dataMalloc();
+            auto outPtr = concat->getOutput()->getRawDataPtr<float *>();
+            EXPECT_EQ(relu0->getOutput()->getRawDataPtr<float *>() == outPtr,
+                      dim == 0);
+            EXPECT_EQ(relu1->getOutput()->getRawDataPtr<float *>() ==
+                          outPtr + 64,
+                      dim == 0);
+
+            i0->setData(IncrementalGenerator());
+            i1->setData(OneGenerator());
+            runtime->run(g);
+            vector<float> ans(128);
+            for (size_t j = 0; j < ans.size(); ++j)
+            {
+                size_t row = dim == 0 ? j / 16 : j / 32;
+                size_t col = dim == 0 ? j % 16 : j % 32;
+                bool first = dim == 0 ? row < 4 : col < 16;
+                ans[j] = first ? (dim == 0 ? j : row * 16 + col) : 1;
+            }
+            EXPECT_TRUE(concat->getOutput()->equalData(ans));
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include "core/graph.h"
+#include "core/quantization.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+#include "operators/quantized_matmul.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini
+{
+    // Deterministic values in [-1, 1)
+    static vector<float> sampleData(size_t n, int seed)
+    {
+        vector<float> data(n);
+        for (size_t i = 0; i < n; ++i)
+            data[i] = float((i * 7919 + seed * 104729) % 2000) / 1000.f - 1.f;
+        return data;
+    }
+
+    static void setFloatData(const Tensor &tensor, const vector<float> &data)
+    {
+        tensor->setData([&](void *ptr, size_t size, DataType)
+                        { std::copy_n(data.data(), size, static_cast<float *>(ptr)); });
+    }
+
+    TEST(Quantization, MatmulGraph)
+    {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        // x * w1 -> Relu -> * w2^T, where w1 is also read by a float Relu
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({8, 64});
+        auto w1 = g->addTensor({64, 48});
+        auto w2 = g->addTensor({16, 48});
+        auto h = g->addOp<MatmulObj>(x, w1, nullptr)->getOutput();
+        auto r = g->addOp<ReluObj>(h, nullptr)->getOutput();
+        auto y = g->addOp<MatmulObj>(r, w2, nullptr, false, true)->getOutput();
+        auto w1r = g->addOp<ReluObj>(w1, nullptr)->getOutput();
+        g->setConstant(w1);
+        g->setConstant(w2);
+        setFloatData(w1, sampleData(w1->size(), 1));
+        setFloatData(w2, sampleData(w2->size(), 2));
+        g->dataMalloc();
+
+        vector<CalibrationSample> calibration;
+        for (int seed = 3; seed < 7; ++seed)
+            calibration.push_back({{x, sampleData(x->size(), seed)}});
+        auto result = quantizeGraph(g, calibration);
+
+        ASSERT_EQ(result.layers.size(), 2u);
+        int quantized = 0, quantizes = 0, matmuls = 0;
+        for (auto &op : result.graph->getOperators())
+        {
+            if (op->getOpType() == OpType::QuantizedMatMul)
+            {
+                ++quantized;
+                EXPECT_TRUE(op->getInputs(1)->isConstant());
+            }
+            quantizes += op->getOpType() == OpType::QuantizeLinear;
+            matmuls += op->getOpType() == OpType::MatMul;
+        }
+        EXPECT_EQ(quantized, 2);
+        EXPECT_EQ(quantizes, 2);
+        EXPECT_EQ(matmuls, 0);
+        EXPECT_TRUE(result.tensors.at(w1)->isConstant());
+        for (auto &layer : result.layers)
+        {
+            EXPECT_GT(layer.rmsError, 0.f);
+            EXPECT_LT(layer.relativeError, 0.02f);
+        }
+
+        // the quantized graph approximates the float one on new data
+        auto data = sampleData(x->size(), 11);
+        setFloatData(x, data);
+        runtime->run(g);
+        setFloatData(result.tensors.at(x), data);
+        runtime->run(result.graph);
+        auto ref = y->getRawDataPtr<float *>();
+        auto out = result.tensors.at(y)->getRawDataPtr<float *>();
+        double error = 0, norm = 0;
+        for (size_t i = 0; i < y->size(); ++i)
+        {
+            error += (out[i] - ref[i]) * (out[i] - ref[i]);
+            norm += ref[i] * ref[i];
+        }
+        EXPECT_LT(std::sqrt(error / norm), 0.03);
+        EXPECT_TRUE(result.tensors.at(w1r)->equalData(w1r));
+    }
+
+} // namespace infini
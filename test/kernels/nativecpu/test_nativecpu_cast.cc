@@ -0,0 +1,124 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+#include "utils/half.h"
+
+#include "test.h"
+
+namespace infini {
+
+template <typename Src, typename Dst>
+void testCastNativeCpu(const vector<Src> &input, DataType dtype,
+                       CastType castType, const vector<Dst> &ans) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto i = g->addTensor({(int)input.size()}, dtype);
+    auto op = g->addOp<CastObj>(i, nullptr, castType);
+    g->dataMalloc();
+    i->setData([&](void *ptr, size_t size, DataType) {
+        std::copy_n(input.data(), size, static_cast<Src *>(ptr));
+    });
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(ans));
+}
+
+// 'n' values from 'gen', long enough to cover the vector loops and their
+// scalar tails
+template <typename T> vector<T> generate(size_t n, T (*gen)(size_t)) {
+    vector<T> ans(n);
+    for (size_t i = 0; i < n; ++i)
+        ans[i] = gen(i);
+    return ans;
+}
+
+TEST(Cast, NativeCpuHalf) {
+    auto floats = generate<float>(
+        37, [](size_t i) { return (float(i) - 18.f) * 0.375f; });
+    // these values are exact in fp16 and bf16
+    vector<float16_t> halfs(floats.begin(), floats.end());
+    vector<bfloat16_t> bfloat16s(floats.begin(), floats.end());
+    testCastNativeCpu(floats, DataType::Float32, CastType::Float2Float16,
+                      halfs);
+    testCastNativeCpu(halfs, DataType::Float16, CastType::Float162Float,
+                      floats);
+    testCastNativeCpu(floats, DataType::Float32, CastType::Float2BFloat16,
+                      bfloat16s);
+    testCastNativeCpu(bfloat16s, DataType::BFloat16, CastType::BFloat162Float,
+                      floats);
+
+    EXPECT_EQ(floatToHalf(1.f), 0x3c00);
+    EXPECT_EQ(floatToHalf(65504.f), 0x7bff);
+    EXPECT_EQ(floatToHalf(1e6f), 0x7c00);
+    EXPECT_EQ(floatToHalf(5.96046448e-8f), 0x0001);
+    // ties round to even
+    EXPECT_EQ(floatToHalf(1.f + 1.f / 2048), 0x3c00);
+    EXPECT_EQ(floatToHalf(1.f + 3.f / 2048), 0x3c02);
+    EXPECT_EQ(floatToBFloat16(1.f + 1.f / 256), 0x3f80);
+    EXPECT_EQ(floatToBFloat16(1.f + 3.f / 256), 0x3f82);
+    EXPECT_EQ(halfToFloat(0x0001), 5.96046448e-8f);
+    EXPECT_EQ(halfToFloat(0xfc00), -INFINITY);
+}
+
+TEST(Cast, NativeCpuInteger) {
+    auto floats = generate<float>(
+        37, [](size_t i) { return (float(i) - 18.f) * 9.75f; });
+    auto int32s = generate<int32_t>(
+        37, [](size_t i) { return int32_t((int(i) - 18) * 9.75f); });
+    // float to int8 saturates
+    auto int8s = generate<int8_t>(37, [](size_t i) {
+        return int8_t(std::clamp(int((int(i) - 18) * 9.75f), -128, 127));
+    });
+    testCastNativeCpu(floats, DataType::Float32, CastType::Float2Int32, int32s);
+    testCastNativeCpu(floats, DataType::Float32, CastType::Float2Int8, int8s);
+    testCastNativeCpu(int32s, DataType::Int32, CastType::Int322Float,
+                      generate<float>(37, [](size_t i) {
+                          return float(int32_t((int(i) - 18) * 9.75f));
+                      }));
+    testCastNativeCpu(int8s, DataType::Int8, CastType::Int82Float,
+                      generate<float>(37, [](size_t i) {
+                          return float(std::clamp(int((int(i) - 18) * 9.75f),
+                                                  -128, 127));
+                      }));
+
+    auto int64s = generate<int64_t>(
+        37, [](size_t i) { return (int64_t(i) - 18) * 123456789; });
+    testCastNativeCpu(int64s, DataType::Int64, CastType::Int642Int32,
+                      generate<int32_t>(37, [](size_t i) {
+                          return int32_t((int64_t(i) - 18) * 123456789);
+                      }));
+    testCastNativeCpu(int32s, DataType::Int32, CastType::Int322Int64,
+                      generate<int64_t>(37, [](size_t i) {
+                          return int64_t(int32_t((int(i) - 18) * 9.75f));
+                      }));
+    testCastNativeCpu(int32s, DataType::Int32, CastType::Int322Int8,
+                      generate<int8_t>(37, [](size_t i) {
+                          return int8_t(int32_t((int(i) - 18) * 9.75f));
+                      }));
+    testCastNativeCpu(floats, DataType::Float32, CastType::Float2Float, floats);
+
+    // float to integers saturates out of range, and NaN becomes 0
+    auto specials = generate<float>(37, [](size_t i) {
+        const float special[] = {INFINITY, -INFINITY, 3e9f, -3e9f, NAN, 1e20f};
+        return i % 7 < 6 ? special[i % 7] : float(i) - 18.f;
+    });
+    testCastNativeCpu(specials, DataType::Float32, CastType::Float2Int32,
+                      generate<int32_t>(37, [](size_t i) {
+                          const int32_t max = INT32_MAX, min = INT32_MIN;
+                          const int32_t ans[] = {max, min, max, min, 0, max};
+                          return i % 7 < 6 ? ans[i % 7] : int32_t(int(i) - 18);
+                      }));
+    testCastNativeCpu(specials, DataType::Float32, CastType::Float2Int8,
+                      generate<int8_t>(37, [](size_t i) {
+                          const int8_t ans[] = {127, -128, 127, -128, 0, 127};
+                          return i % 7 < 6 ? ans[i % 7] : int8_t(int(i) - 18);
+                      }));
+    testCastNativeCpu(specials, DataType::Float32, CastType::Float2Int64,
+                      generate<int64_t>(37, [](size_t i) {
+                          const int64_t max = INT64_MAX, min = INT64_MIN;
+                          const int64_t ans[] = {max, min, 3000000000,
+                                                 -3000000000, 0, max};
+                          return i % 7 < 6 ? ans[i % 7] : int64_t(int(i) - 18);
+                      }));
+}
+
+} // namespace infini
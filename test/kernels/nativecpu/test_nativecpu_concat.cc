@@ -25,4 +25,53 @@ TEST(Concat, NativeCpu) {
                       6, 7, 8, 1, 1, 1, 9, 10, 11, 1, 1, 1}));
 }
 
+// Checks the block copies against element-by-element placement, with
+// inputs filled by byte so that any element size can be checked
+static void testConcatNativeCpu(const vector<Shape> &inDims, int dim,
+                                DataType dtype, int threads = 0) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    if (threads > 0) {
+        runtime = make_ref<NativeCpuRuntimeObj>();
+        runtime->setNumThreads(threads);
+    }
+    Graph g = make_ref<GraphObj>(runtime);
+    TensorVec inputs;
+    for (const auto &dims : inDims)
+        inputs.push_back(g->addTensor(dims, dtype));
+    auto op = g->addOp<ConcatObj>(inputs, nullptr, dim);
+    g->dataMalloc();
+    for (size_t i = 0; i < inputs.size(); ++i)
+        inputs[i]->setData([i](void *ptr, size_t size, DataType dtype) {
+            auto bytes = static_cast<uint8_t *>(ptr);
+            for (size_t j = 0; j < size * dtype.getSize(); ++j)
+                bytes[j] = uint8_t(j * 7 + i * 31);
+        });
+    runtime->run(g);
+
+    auto output = op->getOutput();
+    size_t elemSize = dtype.getSize(), outer = 1;
+    for (int i = 0; i < op->getDim(); ++i)
+        outer *= output->getDims()[i];
+    vector<uint8_t> ans;
+    for (size_t o = 0; o < outer; ++o)
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            size_t block = inputs[i]->size() / outer * elemSize;
+            for (size_t j = o * block; j < (o + 1) * block; ++j)
+                ans.push_back(uint8_t(j * 7 + i * 31));
+        }
+    auto outPtr = output->getRawDataPtr<uint8_t *>();
+    EXPECT_EQ(vector<uint8_t>(outPtr, outPtr + ans.size()), ans);
+}
+
+TEST(Concat, NativeCpuBlocks) {
+    testConcatNativeCpu({{2, 3, 4}, {2, 5, 4}}, 1, DataType::Float32);
+    testConcatNativeCpu({{2, 3, 4}, {2, 3, 1}, {2, 3, 7}}, -1,
+                        DataType::UInt8);
+    testConcatNativeCpu({{3, 4}, {2, 4}}, 0, DataType::Int64);
+    testConcatNativeCpu({{2, 2, 3}, {2, 1, 3}}, 1, DataType::Float16);
+    // split across threads, by blocks or within the blocks
+    testConcatNativeCpu({{64, 300}, {64, 1000}}, 1, DataType::Float32, 4);
+    testConcatNativeCpu({{100000}, {50000}}, 0, DataType::Float32, 4);
+}
+
 } // namespace infini
@@ -1,6 +1,7 @@
 #include "core/graph.h"
 #include "core/runtime.h"
 #include "operators/element_wise.h"
+#include "utils/operator_utils.h"
 
 #include "test.h"
 
@@ -41,4 +42,122 @@ TEST(ElementWise, NativeCpu) {
         Shape{2, 1, 1}, ExpectOutput{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
 }
 
+// Checks Sub (which is not commutative) against per-element index decoding
+static void testBroadcastNativeCpu(const Shape &shapeA, const Shape &shapeB,
+                                   BroadcastInfo::Kind kind, int threads = 0) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    if (threads > 0) {
+        runtime = make_ref<NativeCpuRuntimeObj>();
+        runtime->setNumThreads(threads);
+    }
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(shapeA, DataType::Float32);
+    auto b = g->addTensor(shapeB, DataType::Float32);
+    auto op = g->addOp<SubObj>(a, b, nullptr);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData([](void *ptr, size_t size, DataType) {
+        for (size_t i = 0; i < size; ++i)
+            static_cast<float *>(ptr)[i] = float(i * i % 7);
+    });
+    runtime->run(g);
+
+    auto shapeC = op->getOutput()->getDims();
+    EXPECT_EQ(analyze_broadcast(shapeA, shapeB, shapeC).kind, kind);
+    auto rank = shapeC.size();
+    auto pad = [&](const Shape &shape) {
+        Shape ans(rank, 1);
+        std::copy(shape.begin(), shape.end(), ans.end() - shape.size());
+        return ans;
+    };
+    auto getStride = [&](const Shape &shape) {
+        Shape stride(rank);
+        int p = 1;
+        for (auto i = rank; i > 0; --i) {
+            stride[i - 1] = p;
+            p *= shape[i - 1];
+        }
+        return stride;
+    };
+    Shape a1 = pad(shapeA), b1 = pad(shapeB);
+    vector<float> ans(op->getOutput()->size());
+    for (size_t i = 0; i < ans.size(); ++i) {
+        auto index = locate_index(i, shapeC);
+        auto indexB = delocate_index(index, b1, getStride(b1));
+        ans[i] = float(delocate_index(index, a1, getStride(a1))) -
+                 float(indexB * indexB % 7);
+    }
+    EXPECT_TRUE(op->getOutput()->equalData(ans));
+}
+
+TEST(ElementWise, NativeCpuBroadcast) {
+    testBroadcastNativeCpu({2, 3, 17}, {2, 3, 17}, BroadcastInfo::Same);
+    testBroadcastNativeCpu({1, 4}, {1, 4}, BroadcastInfo::Same);
+    testBroadcastNativeCpu({}, {3, 25}, BroadcastInfo::ScalarA);
+    testBroadcastNativeCpu({3, 25}, {1, 1}, BroadcastInfo::ScalarB);
+    testBroadcastNativeCpu({5}, {2, 3, 5}, BroadcastInfo::RowA);
+    testBroadcastNativeCpu({3, 41}, {41}, BroadcastInfo::RowB);
+    testBroadcastNativeCpu({2, 3, 5}, {1, 3, 5}, BroadcastInfo::RowB);
+    testBroadcastNativeCpu({2, 3, 1}, {2, 3, 5}, BroadcastInfo::ColumnA);
+    testBroadcastNativeCpu({3, 1}, {3, 19}, BroadcastInfo::ColumnA);
+    testBroadcastNativeCpu({4, 1, 5, 7}, {4, 1, 5, 1}, BroadcastInfo::ColumnB);
+    testBroadcastNativeCpu({4, 1}, {1, 5}, BroadcastInfo::General);
+    testBroadcastNativeCpu({2, 3, 4, 5}, {3, 1, 5}, BroadcastInfo::General);
+    testBroadcastNativeCpu({2, 1, 4, 1}, {1, 3, 1, 5}, BroadcastInfo::General);
+    testBroadcastNativeCpu({2, 3, 33}, {2, 1, 33}, BroadcastInfo::General);
+    // empty outputs
+    testBroadcastNativeCpu({3, 0}, {1, 0}, BroadcastInfo::RowB);
+    testBroadcastNativeCpu({2, 1, 0}, {1, 3, 0}, BroadcastInfo::General);
+}
+
+// Add, Sub, Mul and Div of a [2, 3, 4] tensor and a broadcast [4] one
+template <typename T> static void testElementWiseDType(DataType dtype) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3, 4}, dtype);
+    auto b = g->addTensor({4}, dtype);
+    auto add = g->addOp<AddObj>(a, b, nullptr);
+    auto sub = g->addOp<SubObj>(a, b, nullptr);
+    auto mul = g->addOp<MulObj>(a, b, nullptr);
+    auto div = g->addOp<DivObj>(a, b, nullptr);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData([](void *ptr, size_t size, DataType) {
+        for (size_t i = 0; i < size; ++i)
+            static_cast<T *>(ptr)[i] = T(i + 1);
+    });
+    runtime->run(g);
+
+    vector<T> addAns, subAns, mulAns, divAns;
+    for (int i = 0; i < 24; ++i) {
+        T x = T(i), y = T(i % 4 + 1);
+        addAns.push_back(T(x + y));
+        subAns.push_back(T(x - y));
+        mulAns.push_back(T(x * y));
+        divAns.push_back(T(x / y));
+    }
+    EXPECT_TRUE(add->getOutput()->equalData(addAns));
+    EXPECT_TRUE(sub->getOutput()->equalData(subAns));
+    EXPECT_TRUE(mul->getOutput()->equalData(mulAns));
+    EXPECT_TRUE(div->getOutput()->equalData(divAns));
+}
+
+TEST(ElementWise, NativeCpuDTypes) {
+    testElementWiseDType<int8_t>(DataType::Int8);
+    testElementWiseDType<int32_t>(DataType::Int32);
+    testElementWiseDType<int64_t>(DataType::Int64);
+    testElementWiseDType<double>(DataType::Double);
+    testElementWiseDType<float16_t>(DataType::Float16);
+    testElementWiseDType<bfloat16_t>(DataType::BFloat16);
+}
+
+TEST(ElementWise, NativeCpuThreads) {
+    // large enough to be split across the threads
+    testBroadcastNativeCpu({3, 50001}, {3, 50001}, BroadcastInfo::Same, 4);
+    testBroadcastNativeCpu({}, {100003}, BroadcastInfo::ScalarA, 4);
+    testBroadcastNativeCpu({4001, 33}, {33}, BroadcastInfo::RowB, 4);
+    testBroadcastNativeCpu({5001, 1}, {5001, 20}, BroadcastInfo::ColumnA, 4);
+    testBroadcastNativeCpu({40, 30, 101}, {30, 1}, BroadcastInfo::General, 4);
+}
+
 } // namespace infini
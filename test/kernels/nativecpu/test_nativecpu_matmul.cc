@@ -0,0 +1,243 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+
+#include "test.h"
+
+namespace infini {
+
+// C = op(A) * op(B) computed element by element, with the batch broadcast of
+// MatmulObj::inferShape
+static vector<float> matmulReference(const vector<float> &a, const Shape &aDims,
+                                     const vector<float> &b, const Shape &bDims,
+                                     const Shape &cDims, bool transA,
+                                     bool transB) {
+    size_t rank = cDims.size();
+    size_t m = cDims[rank - 2], n = cDims[rank - 1];
+    size_t k = transA ? aDims[aDims.size() - 2] : aDims.back();
+    size_t batch = 1;
+    for (size_t i = 0; i + 2 < rank; ++i)
+        batch *= cDims[i];
+    auto offset = [&](const Shape &dims, size_t c) {
+        size_t ans = 0, stride = dims[dims.size() - 2] * dims.back();
+        for (size_t i = 0; i + 2 < dims.size(); ++i) {
+            size_t dim = dims.size() - 3 - i, cDim = rank - 3 - i;
+            size_t rest = c;
+            for (size_t j = rank - 2; j > cDim + 1; --j)
+                rest /= cDims[j - 1];
+            ans += (dims[dim] == 1 ? 0 : rest % cDims[cDim]) * stride;
+            stride *= dims[dim];
+        }
+        return ans;
+    };
+    vector<float> c(batch * m * n, 0);
+    for (size_t bi = 0; bi < batch; ++bi) {
+        const float *pa = a.data() + offset(aDims, bi);
+        const float *pb = b.data() + offset(bDims, bi);
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j) {
+                float sum = 0;
+                for (size_t p = 0; p < k; ++p)
+                    sum += (transA ? pa[p * m + i] : pa[i * k + p]) *
+                           (transB ? pb[j * k + p] : pb[p * n + j]);
+                c[(bi * m + i) * n + j] = sum;
+            }
+    }
+    return c;
+}
+
+// The fused epilogue: c + bias, broadcast to cDims, then clipped
+static void epilogueReference(vector<float> &c, const Shape &cDims,
+                              const vector<float> &bias, const Shape &biasDims,
+                              optional<float> clipMin, optional<float> clipMax) {
+    for (size_t i = 0; i < c.size(); ++i) {
+        if (!biasDims.empty()) {
+            size_t index = 0, stride = 1;
+            for (size_t d = 0, rest = i; d < biasDims.size(); ++d) {
+                size_t dim = biasDims[biasDims.size() - 1 - d];
+                size_t cDim = cDims[cDims.size() - 1 - d];
+                index += (dim == 1 ? 0 : rest % cDim) * stride;
+                rest /= cDim;
+                stride *= dim;
+            }
+            c[i] += bias[index];
+        }
+        if (clipMin)
+            c[i] = std::max(c[i], *clipMin);
+        if (clipMax)
+            c[i] = std::min(c[i], *clipMax);
+    }
+}
+
+template <typename T = float>
+static void testMatmulNativeCpu(const Shape &aDims, const Shape &bDims,
+                                bool transA, bool transB,
+                                DataType dtype = DataType::Float32,
+                                const Shape &biasDims = {},
+                                optional<float> clipMin = std::nullopt,
+                                optional<float> clipMax = std::nullopt) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(aDims, dtype);
+    auto b = g->addTensor(bDims, dtype);
+    auto bias = biasDims.empty() ? nullptr : g->addTensor(biasDims, dtype);
+    auto op = g->addOp<MatmulObj>(a, b, nullptr, transA, transB, bias);
+    op->setClip(clipMin, clipMax);
+    g->dataMalloc();
+
+    // small integers keep the sums exact in fp32
+    auto fill = [](vector<float> &vec, int seed) {
+        for (size_t i = 0; i < vec.size(); ++i)
+            vec[i] = float(int((i * 7 + seed) % 11) - 5);
+    };
+    vector<float> aData(a->size()), bData(b->size());
+    fill(aData, 1);
+    fill(bData, 3);
+    a->setData([&](void *ptr, size_t size, DataType) {
+        std::copy_n(aData.data(), size, static_cast<T *>(ptr));
+    });
+    b->setData([&](void *ptr, size_t size, DataType) {
+        std::copy_n(bData.data(), size, static_cast<T *>(ptr));
+    });
+    vector<float> biasData;
+    if (bias) {
+        biasData.resize(bias->size());
+        fill(biasData, 5);
+        bias->setData([&](void *ptr, size_t size, DataType) {
+            std::copy_n(biasData.data(), size, static_cast<T *>(ptr));
+        });
+    }
+
+    runtime->run(g);
+    // fp16 and bf16 accumulate in fp32 and round only the result
+    auto cDims = op->getOutput()->getDims();
+    auto ans = matmulReference(aData, aDims, bData, bDims, cDims, transA,
+                               transB);
+    epilogueReference(ans, cDims, biasData, biasDims, clipMin, clipMax);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<T>(ans.begin(), ans.end())));
+}
+
+// A MatMul of A with several Bs, each output checked against the MatMul of A
+// with its B
+template <typename T = float>
+static void testMultiMatmulNativeCpu(const Shape &aDims,
+                                     const vector<Shape> &bDims, bool transB,
+                                     DataType dtype = DataType::Float32,
+                                     optional<float> clipMin = std::nullopt) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(aDims, dtype);
+    TensorVec bs;
+    for (auto &dims : bDims)
+        bs.push_back(g->addTensor(dims, dtype));
+    auto op = g->addOp<MatmulObj>(a, bs, TensorVec(bs.size()), false, transB);
+    op->setClip(clipMin, std::nullopt);
+    g->dataMalloc();
+
+    auto fill = [](const Tensor &tensor, int seed) {
+        vector<float> data(tensor->size());
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = float(int((i * 7 + seed) % 11) - 5);
+        tensor->setData([&](void *ptr, size_t size, DataType) {
+            std::copy_n(data.data(), size, static_cast<T *>(ptr));
+        });
+        return data;
+    };
+    auto aData = fill(a, 1);
+    vector<vector<float>> bData;
+    for (size_t i = 0; i < bs.size(); ++i)
+        bData.push_back(fill(bs[i], 3 + i));
+
+    runtime->run(g);
+    for (size_t i = 0; i < bs.size(); ++i) {
+        auto cDims = op->getOutput(i)->getDims();
+        auto ans = matmulReference(aData, aDims, bData[i], bDims[i], cDims,
+                                   false, transB);
+        epilogueReference(ans, cDims, {}, {}, clipMin, std::nullopt);
+        EXPECT_TRUE(
+            op->getOutput(i)->equalData(vector<T>(ans.begin(), ans.end())));
+    }
+}
+
+TEST(Matmul, NativeCpu) {
+    testMatmulNativeCpu(Shape{2, 3}, Shape{3, 4}, false, false);
+    testMatmulNativeCpu(Shape{3, 2}, Shape{4, 3}, true, true);
+    // sizes that are not multiples of the register and cache blocks
+    testMatmulNativeCpu(Shape{101, 259}, Shape{259, 67}, false, false);
+    testMatmulNativeCpu(Shape{259, 101}, Shape{67, 259}, true, true);
+    testMatmulNativeCpu(Shape{37, 600}, Shape{530, 600}, false, true);
+    // batch broadcast
+    testMatmulNativeCpu(Shape{2, 3, 7, 5}, Shape{5, 9}, false, false);
+    testMatmulNativeCpu(Shape{2, 1, 5, 7}, Shape{1, 3, 9, 5}, true, true);
+    testMatmulNativeCpu(Shape{4, 1, 17, 33}, Shape{3, 33, 18}, false, false);
+    // batches run as one GEMM whose row blocks cross them
+    testMatmulNativeCpu(Shape{4, 50, 33}, Shape{33, 20}, false, false);
+    testMatmulNativeCpu(Shape{2, 3, 50, 33}, Shape{1, 1, 20, 33}, false, true);
+}
+
+TEST(Matmul, NativeCpuHalf) {
+    testMatmulNativeCpu<float16_t>(Shape{2, 3}, Shape{3, 4}, false, false,
+                                   DataType::Float16);
+    testMatmulNativeCpu<float16_t>(Shape{259, 101}, Shape{67, 259}, true,
+                                   true, DataType::Float16);
+    testMatmulNativeCpu<float16_t>(Shape{37, 600}, Shape{530, 600}, false,
+                                   true, DataType::Float16);
+    testMatmulNativeCpu<bfloat16_t>(Shape{101, 259}, Shape{259, 67}, false,
+                                    false, DataType::BFloat16);
+    testMatmulNativeCpu<bfloat16_t>(Shape{2, 1, 5, 7}, Shape{1, 3, 9, 5},
+                                    true, true, DataType::BFloat16);
+}
+
+TEST(Matmul, NativeCpuEpilogue) {
+    // bias per column, per row, per element and per batch, with edge tiles
+    testMatmulNativeCpu(Shape{101, 259}, Shape{259, 67}, false, false,
+                        DataType::Float32, Shape{67});
+    testMatmulNativeCpu(Shape{259, 101}, Shape{67, 259}, true, true,
+                        DataType::Float32, Shape{101, 1}, 0.f);
+    testMatmulNativeCpu(Shape{2, 3, 37, 5}, Shape{5, 40}, false, false,
+                        DataType::Float32, Shape{3, 37, 40}, -20.f, 20.f);
+    testMatmulNativeCpu(Shape{2, 3, 7, 5}, Shape{3, 5, 9}, false, false,
+                        DataType::Float32, Shape{2, 1, 1, 9});
+    testMatmulNativeCpu(Shape{4, 50, 33}, Shape{33, 20}, false, false,
+                        DataType::Float32, Shape{4, 50, 20}, 0.f);
+    testMatmulNativeCpu(Shape{4, 50, 33}, Shape{33, 20}, false, false,
+                        DataType::Float32, Shape{50, 20});
+    // a clip only, and an empty k
+    testMatmulNativeCpu(Shape{37, 600}, Shape{530, 600}, false, true,
+                        DataType::Float32, {}, std::nullopt, 10.f);
+    testMatmulNativeCpu(Shape{3, 0}, Shape{0, 4}, false, false,
+                        DataType::Float32, Shape{4}, 1.f);
+    testMatmulNativeCpu<float16_t>(Shape{101, 259}, Shape{259, 67}, false,
+                                   false, DataType::Float16, Shape{67}, 0.f);
+    testMatmulNativeCpu<int32_t>(Shape{5, 7}, Shape{7, 33}, false, false,
+                                 DataType::Int32, Shape{5, 1}, 0.f, 30.f);
+}
+
+TEST(Matmul, NativeCpuMultipleB) {
+    // Bs narrower than a register tile, across a cache block, and empty
+    testMultiMatmulNativeCpu(Shape{37, 45}, {{45, 5}, {45, 33}, {45, 32}},
+                             false);
+    testMultiMatmulNativeCpu(Shape{2, 3, 101, 40},
+                             {{513, 40}, {0, 40}, {87, 40}}, true,
+                             DataType::Float32, 0.f);
+    testMultiMatmulNativeCpu(Shape{2, 7, 9}, {{2, 9, 12}, {2, 9, 8}}, false);
+    testMultiMatmulNativeCpu<float16_t>(Shape{7, 9}, {{9, 12}, {9, 8}}, false,
+                                        DataType::Float16);
+    testMultiMatmulNativeCpu(Shape{3, 0}, {{0, 2}, {0, 3}}, false,
+                             DataType::Float32, 1.f);
+}
+
+TEST(Matmul, NativeCpuUInt32) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3}, DataType::UInt32);
+    auto b = g->addTensor({3, 2}, DataType::UInt32);
+    auto op = g->addOp<MatmulObj>(a, b, nullptr);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<uint32_t>{10, 13, 28, 40}));
+}
+
+} // namespace infini
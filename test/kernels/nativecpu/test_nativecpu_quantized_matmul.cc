@@ -0,0 +1,128 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/quantized_matmul.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Deterministic int8 values that cover the whole range
+static vector<int8_t> int8Data(size_t n, int seed) {
+    vector<int8_t> data(n);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = int8_t((i * 37 + seed * 11) % 256 - 128);
+    return data;
+}
+
+static void setInt8Data(const Tensor &tensor, const vector<int8_t> &data) {
+    tensor->setData([&](void *ptr, size_t size, DataType) {
+        std::copy_n(data.data(), size, static_cast<int8_t *>(ptr));
+    });
+}
+
+// The exact integer sums of (A - aZero)(B - bZero), scaled like the kernel
+// does, for a 2D problem
+template <typename T>
+static vector<T> quantizedMatmulReference(
+    const vector<int8_t> &a, const vector<int8_t> &b, size_t m, size_t n,
+    size_t k, bool transA, bool transB, const QuantParams &aQuant,
+    const QuantParams &bQuant, const optional<QuantParams> &cQuant) {
+    vector<T> c(m * n);
+    float cScale = cQuant ? cQuant->scales[0] : 1.f;
+    for (size_t j = 0; j < n; ++j) {
+        size_t channel = bQuant.size() == 1 ? 0 : j;
+        int bZero = bQuant.zeroPoints[channel];
+        float scale = aQuant.scales[0] * bQuant.scales[channel] / cScale;
+        for (size_t i = 0; i < m; ++i) {
+            int32_t sum = 0;
+            for (size_t p = 0; p < k; ++p)
+                sum += (int(transA ? a[p * m + i] : a[i * k + p]) -
+                        aQuant.zeroPoints[0]) *
+                       (int(transB ? b[j * k + p] : b[p * n + j]) - bZero);
+            float x = float(sum) * scale;
+            if constexpr (std::is_same_v<T, int8_t>)
+                c[i * n + j] = int8_t(std::clamp(
+                    std::nearbyint(x) + float(cQuant->zeroPoints[0]), -128.f,
+                    127.f));
+            else
+                c[i * n + j] = x;
+        }
+    }
+    return c;
+}
+
+static void testQuantizedMatmulNativeCpu(size_t m, size_t n, size_t k,
+                                         bool transA, bool transB,
+                                         bool perChannel, bool requantize,
+                                         int threads = 1) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    runtime->setNumThreads(threads);
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(transA ? Shape{int(k), int(m)} : Shape{int(m), int(k)},
+                          DataType::Int8);
+    auto b = g->addTensor(transB ? Shape{int(n), int(k)} : Shape{int(k), int(n)},
+                          DataType::Int8);
+    QuantParams aQuant(0.02f, 3), bQuant(0.01f, -2);
+    if (perChannel) {
+        bQuant.scales.clear();
+        bQuant.zeroPoints.clear();
+        for (size_t j = 0; j < n; ++j) {
+            bQuant.scales.push_back(0.005f * (j % 7 + 1));
+            bQuant.zeroPoints.push_back(int(j % 5) - 2);
+        }
+    }
+    optional<QuantParams> cQuant;
+    if (requantize)
+        cQuant = QuantParams(float(k) * 0.01f, -5);
+    auto op = g->addOp<QuantizedMatmulObj>(a, b, nullptr, aQuant, bQuant,
+                                           cQuant, transA, transB);
+    g->dataMalloc();
+    auto aData = int8Data(m * k, 1), bData = int8Data(k * n, 2);
+    setInt8Data(a, aData);
+    setInt8Data(b, bData);
+    runtime->run(g);
+
+    if (requantize)
+        EXPECT_TRUE(op->getOutput()->equalData(quantizedMatmulReference<int8_t>(
+            aData, bData, m, n, k, transA, transB, aQuant, bQuant, cQuant)));
+    else
+        EXPECT_TRUE(op->getOutput()->equalData(quantizedMatmulReference<float>(
+            aData, bData, m, n, k, transA, transB, aQuant, bQuant, cQuant)));
+}
+
+TEST(QuantizedMatmul, NativeCpu) {
+    testQuantizedMatmulNativeCpu(2, 3, 4, false, false, false, false);
+    testQuantizedMatmulNativeCpu(3, 2, 5, true, true, true, true);
+    // sizes that are not multiples of the register blocks, NC or the k
+    // groups
+    testQuantizedMatmulNativeCpu(37, 150, 259, false, false, true, true);
+    testQuantizedMatmulNativeCpu(29, 131, 67, true, false, false, true);
+    testQuantizedMatmulNativeCpu(13, 300, 1001, false, true, true, false);
+    testQuantizedMatmulNativeCpu(50, 270, 127, false, true, true, true, 4);
+}
+
+TEST(QuantizedMatmul, NativeCpuBroadcast) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3, 5}, DataType::Int8);
+    auto b = g->addTensor({5, 4}, DataType::Int8);
+    QuantParams aQuant(0.5f, 1), bQuant(0.25f, -1);
+    auto op = g->addOp<QuantizedMatmulObj>(a, b, nullptr, aQuant, bQuant);
+    g->dataMalloc();
+    auto aData = int8Data(30, 3), bData = int8Data(20, 4);
+    setInt8Data(a, aData);
+    setInt8Data(b, bData);
+    runtime->run(g);
+
+    // both batches of A share B
+    auto ans = quantizedMatmulReference<float>(
+        vector<int8_t>(aData.begin(), aData.begin() + 15), bData, 3, 4, 5,
+        false, false, aQuant, bQuant, std::nullopt);
+    auto ans1 = quantizedMatmulReference<float>(
+        vector<int8_t>(aData.begin() + 15, aData.end()), bData, 3, 4, 5, false,
+        false, aQuant, bQuant, std::nullopt);
+    ans.insert(ans.end(), ans1.begin(), ans1.end());
+    EXPECT_TRUE(op->getOutput()->equalData(ans));
+}
+
+} // namespace infini
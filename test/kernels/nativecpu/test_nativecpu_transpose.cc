@@ -24,4 +24,80 @@ TEST(Transpose, NativeCpu) {
                                                           8, 9, 10, 11, 20, 21, 22, 23}));
 }
 
+// Checks the kernel against element-by-element index mapping
+static void testTransposeNativeCpu(const Shape &inDims,
+                                   const vector<int> &permute,
+                                   int threads = 0) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    if (threads > 0) {
+        runtime = make_ref<NativeCpuRuntimeObj>();
+        runtime->setNumThreads(threads);
+    }
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(inDims, DataType::Float32);
+    auto op = g->addOp<TransposeObj>(input, nullptr, permute);
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+    runtime->run(g);
+
+    size_t rank = inDims.size();
+    vector<size_t> inStrides(rank);
+    for (size_t i = rank, stride = 1; i-- > 0;) {
+        inStrides[i] = stride;
+        stride *= inDims[i];
+    }
+    const auto &outDims = op->getOutput()->getDims();
+    vector<float> ans(input->size());
+    for (size_t i = 0; i < ans.size(); ++i) {
+        size_t rest = i, inIdx = 0;
+        for (size_t j = rank; j-- > 0;) {
+            inIdx += rest % outDims[j] * inStrides[permute[j]];
+            rest /= outDims[j];
+        }
+        ans[i] = float(inIdx);
+    }
+    EXPECT_TRUE(op->getOutput()->equalData(ans));
+}
+
+TEST(Transpose, NativeCpuDTypes) {
+    // the kernel only looks at the element size
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto i8 = g->addTensor({2, 3}, DataType::Int8);
+    auto f16 = g->addTensor({2, 3}, DataType::Float16);
+    auto i64 = g->addTensor({2, 3}, DataType::Int64);
+    auto op8 = g->addOp<TransposeObj>(i8, nullptr, vector<int>{1, 0});
+    auto op16 = g->addOp<TransposeObj>(f16, nullptr, vector<int>{1, 0});
+    auto op64 = g->addOp<TransposeObj>(i64, nullptr, vector<int>{1, 0});
+    g->dataMalloc();
+    i8->setData(IncrementalGenerator());
+    f16->setData(IncrementalGenerator());
+    i64->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(op8->getOutput()->equalData(vector<int8_t>{0, 3, 1, 4, 2, 5}));
+    EXPECT_TRUE(op16->getOutput()->equalData(
+        vector<float16_t>{0.f, 3.f, 1.f, 4.f, 2.f, 5.f}));
+    EXPECT_TRUE(
+        op64->getOutput()->equalData(vector<int64_t>{0, 3, 1, 4, 2, 5}));
+}
+
+TEST(Transpose, NativeCpuGeneral) {
+    // planes with edge tiles and 8x8 blocks
+    testTransposeNativeCpu({3, 70, 133}, {0, 2, 1});
+    testTransposeNativeCpu({67, 9}, {1, 0});
+    testTransposeNativeCpu({2, 3, 4, 5}, {3, 1, 0, 2});
+    testTransposeNativeCpu({2, 3, 4, 5}, {2, 3, 0, 1});
+    // the innermost dim stays innermost
+    testTransposeNativeCpu({2, 3, 4, 5}, {1, 0, 2, 3});
+    testTransposeNativeCpu({4, 3, 2, 5}, {2, 0, 1, 3});
+    // size-1 dims and dims that stay contiguous
+    testTransposeNativeCpu({1, 6, 1, 7}, {3, 2, 1, 0});
+    testTransposeNativeCpu({4, 1, 3}, {1, 0, 2});
+    testTransposeNativeCpu({2, 3, 4, 5, 6}, {3, 4, 0, 1, 2});
+    testTransposeNativeCpu({8, 8}, {0, 1});
+    // batched attention-style transposes across threads
+    testTransposeNativeCpu({2, 4, 128, 64}, {0, 1, 3, 2}, 4);
+    testTransposeNativeCpu({2, 128, 4, 64}, {0, 2, 1, 3}, 4);
+}
+
 } // namespace infini
@@ -0,0 +1,106 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// runs op on 'input', long enough to cover the vector loops and their tails
+template <typename T, typename... Args>
+static void testUnaryNativeCpu(const Runtime &runtime,
+                               const vector<float> &input,
+                               const vector<float> &ans, Args... args) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto i = g->addTensor({(int)input.size()}, DataType::Float32);
+    auto op = g->addOp<T>(i, nullptr, args...);
+    g->dataMalloc();
+    i->setData([&](void *ptr, size_t size, DataType) {
+        std::copy_n(input.data(), size, static_cast<float *>(ptr));
+    });
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(ans));
+}
+
+TEST(Unary, NativeCpuRelu) {
+    vector<float> input(37), ans(37);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = float(i % 5) - 2.5f;
+        ans[i] = std::max(0.f, input[i]);
+    }
+    testUnaryNativeCpu<ReluObj>(NativeCpuRuntimeObj::getInstance(), input,
+                                ans);
+}
+
+TEST(Unary, NativeCpuClip) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    vector<float> input(37), both(37), minOnly(37), maxOnly(37);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = float(i) - 18.5f;
+        both[i] = std::min(std::max(input[i], -3.f), 7.f);
+        minOnly[i] = std::max(input[i], -3.f);
+        maxOnly[i] = std::min(input[i], 7.f);
+    }
+    testUnaryNativeCpu<ClipObj>(runtime, input, both, -3.f, 7.f);
+    testUnaryNativeCpu<ClipObj>(runtime, input, minOnly, -3.f, std::nullopt);
+    testUnaryNativeCpu<ClipObj>(runtime, input, maxOnly, std::nullopt, 7.f);
+}
+
+TEST(Unary, NativeCpuThreads) {
+    // large enough to be split across the threads
+    Runtime runtime = make_ref<NativeCpuRuntimeObj>();
+    runtime->setNumThreads(4);
+    vector<float> input(100003), relu(input.size()), clip(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = float(i % 101) - 50.f;
+        relu[i] = std::max(0.f, input[i]);
+        clip[i] = std::min(std::max(input[i], -3.f), 7.f);
+    }
+    testUnaryNativeCpu<ReluObj>(runtime, input, relu);
+    testUnaryNativeCpu<ClipObj>(runtime, input, clip, -3.f, 7.f);
+}
+
+TEST(Unary, NativeCpuClipUInt32) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto i = g->addTensor({2, 3}, DataType::UInt32);
+    auto op = g->addOp<ClipObj>(i, nullptr, -1.f, 3.f);
+    g->dataMalloc();
+    i->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<uint32_t>{0, 1, 2, 3, 3, 3}));
+}
+
+// Relu and Clip to [-3, 7] of -10 ... 9
+template <typename T> static void testUnaryDType(DataType dtype) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto i = g->addTensor({20}, dtype);
+    auto relu = g->addOp<ReluObj>(i, nullptr);
+    auto clip = g->addOp<ClipObj>(i, nullptr, -3.f, 7.f);
+    g->dataMalloc();
+    i->setData([](void *ptr, size_t size, DataType) {
+        for (size_t j = 0; j < size; ++j)
+            static_cast<T *>(ptr)[j] = T(int(j) - 10);
+    });
+    runtime->run(g);
+
+    vector<T> reluAns, clipAns;
+    for (int j = -10; j < 10; ++j) {
+        reluAns.push_back(T(std::max(j, 0)));
+        clipAns.push_back(T(std::min(std::max(j, -3), 7)));
+    }
+    EXPECT_TRUE(relu->getOutput()->equalData(reluAns));
+    EXPECT_TRUE(clip->getOutput()->equalData(clipAns));
+}
+
+TEST(Unary, NativeCpuDTypes) {
+    testUnaryDType<int8_t>(DataType::Int8);
+    testUnaryDType<int32_t>(DataType::Int32);
+    testUnaryDType<int64_t>(DataType::Int64);
+    testUnaryDType<double>(DataType::Double);
+    testUnaryDType<float16_t>(DataType::Float16);
+    testUnaryDType<bfloat16_t>(DataType::BFloat16);
+}
+
+} // namespace infini
@@ -0,0 +1,43 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/quantized_matmul.h"
+
+#include "test.h"
+
+namespace infini
+{
+
+    TEST(QuantizedMatmul, ShapeInference)
+    {
+        auto runtime = NativeCpuRuntimeObj::getInstance();
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto A = g->addTensor(Shape{2, 3, 5}, DataType::Int8);
+            auto B = g->addTensor(Shape{4, 5}, DataType::Int8);
+            QuantParams bQuant({0.1f, 0.2f, 0.3f, 0.4f}, {0, 0, 0, 0});
+            auto matmul = g->addOp<QuantizedMatmulObj>(
+                A, B, nullptr, QuantParams(0.5f, 1), bQuant, std::nullopt,
+                false, true);
+            auto C = matmul->getOutput();
+            EXPECT_EQ(C->getDims(), (Shape{2, 3, 4}));
+            EXPECT_EQ(C->getDType(), DataType::Float32);
+            EXPECT_EQ(matmul->getMaxK(), 65536u);
+        }
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto A = g->addTensor(Shape{5, 3}, DataType::Int8);
+            auto B = g->addTensor(Shape{5, 2}, DataType::Int8);
+            auto matmul = g->addOp<QuantizedMatmulObj>(
+                A, B, nullptr, QuantParams(0.5f, 1), QuantParams(0.1f, 0),
+                QuantParams(2.f, -3), true, false);
+            auto C = matmul->getOutput();
+            EXPECT_EQ(C->getDims(), (Shape{3, 2}));
+            EXPECT_EQ(C->getDType(), DataType::Int8);
+        }
+        // an asymmetric B halves the k whose sums fit in int32
+        EXPECT_EQ(QuantizedMatmulObj::maxK(QuantParams({0.1f, 0.2f}, {0, 5})),
+                  33025u);
+    }
+
+}; // namespace infini